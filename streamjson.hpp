@@ -20,624 +20,7814 @@
 #include <array>
 #include <vector>
 #include <functional>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+#include <bit>
 
 #include <ctre.hpp>
 
+#ifdef STREAMJSON_ZLIB
+#include <zlib.h>
+#endif
+
 namespace streamjson
 {
 
-/**
- * @class JSONValue
- *
- * @brief A simple class to hold a JSON value
-*/
-struct JSONValue
+namespace detail
+{
+
+// SWAR (SIMD within a register) helpers, 8 bytes are checked at once
+
+inline uint64_t load64(const char * data)
+{
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+constexpr uint64_t broadcast(uint8_t byte)
+{
+    return 0x0101010101010101ULL * byte;
+}
+
+// Non zero if any byte of word is zero
+constexpr uint64_t has_zero_byte(uint64_t word)
+{
+    return (word - broadcast(0x01)) & ~word & broadcast(0x80);
+}
+
+// Non zero if any byte of word is equal to byte
+constexpr uint64_t has_byte(uint64_t word, uint8_t byte)
+{
+    return has_zero_byte(word ^ broadcast(byte));
+}
+
+// Non zero if any byte of word is lower than limit (limit <= 128)
+constexpr uint64_t has_less_than(uint64_t word, uint8_t limit)
+{
+    return (word - broadcast(limit)) & ~word & broadcast(0x80);
+}
+
+// Little endian load, so hashes do not depend on the platform
+inline uint64_t load64_le(const char * data)
+{
+    if constexpr (std::endian::native == std::endian::little)
     {
-        enum class Type
-        {
-            STRING,
-            FLOATING,
-            INTEGER,
-            BOOLEAN,
-            INVALID
-        };
+        return load64(data);
+    }
 
-        Type type;
+    uint64_t word = 0;
+    for (size_t i = 0; i < 8; i++)
+    {
+        word |= uint64_t(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
 
-        std::string string;
-        union
+    return word;
+}
+
+// Finalizer of splitmix64
+constexpr uint64_t mix64(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+// 64 bit hash of a byte range, one multiply per eight bytes
+inline uint64_t hash_bytes(const char * data, size_t size, uint64_t seed = 0)
+{
+    uint64_t hash = seed ^ (size * 0x9e3779b97f4a7c15ULL);
+    size_t i = 0;
+
+    for (; i + 8 <= size; i += 8)
+    {
+        hash = (hash ^ mix64(load64_le(data + i))) * 0x9e3779b97f4a7c15ULL;
+    }
+
+    uint64_t tail = 0;
+    for (size_t shift = 0; i < size; i++, shift += 8)
+    {
+        tail |= uint64_t(static_cast<unsigned char>(data[i])) << shift;
+    }
+
+    return mix64(hash ^ mix64(tail));
+}
+
+// Decode the escape sequences of a raw JSON string into UTF-8
+inline void unescape(const std::string_view & raw, std::string & output)
+{
+    output.clear();
+    output.reserve(raw.size());
+
+    auto hex4 = [&](size_t position) -> uint32_t
+    {
+        uint32_t value = 0;
+        if (position + 4 > raw.size() || std::from_chars(raw.data() + position, raw.data() + position + 4, value, 16).ec != std::errc())
         {
-            double floating;
-            int64_t integer;
-            bool boolean;
-        };
+            return 0xFFFD;
+        }
+        return value;
+    };
 
-        JSONValue(const char * string, size_t size)
+    for (size_t i = 0; i < raw.size(); i++)
+    {
+        if (raw[i] != '\\' || i + 1 == raw.size())
         {
-            bool success = parse_string(string, size);
-            success = success || parse_number(string, size);
-            success = success || parse_boolean(string, size);
+            output += raw[i];
+            continue;
+        }
 
-            if (!success)
+        const char c = raw[++i];
+        switch (c)
+        {
+            case 'b': output += '\b'; break;
+            case 'f': output += '\f'; break;
+            case 'n': output += '\n'; break;
+            case 'r': output += '\r'; break;
+            case 't': output += '\t'; break;
+            case 'u':
             {
-                type = Type::INVALID;
+                uint32_t code = hex4(i + 1);
+                i += 4;
+
+                // Surrogate pair
+                if (code >= 0xD800 && code <= 0xDBFF && i + 2 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u')
+                {
+                    uint32_t low = hex4(i + 3);
+                    if (low >= 0xDC00 && low <= 0xDFFF)
+                    {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+
+                if (code < 0x80)
+                {
+                    output += static_cast<char>(code);
+                }
+                else if (code < 0x800)
+                {
+                    output += static_cast<char>(0xC0 | (code >> 6));
+                    output += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    output += static_cast<char>(0xE0 | (code >> 12));
+                    output += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    output += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    output += static_cast<char>(0xF0 | (code >> 18));
+                    output += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    output += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    output += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                break;
             }
+            default:
+                // \" \\ \/
+                output += c;
+                break;
         }
+    }
+}
 
-        std::string to_string() const
+// Escape a string as the content of a raw JSON string, as found in the input
+inline void escape(const std::string_view & string, std::string & output)
+{
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    output.clear();
+    output.reserve(string.size());
+
+    const char * data = string.data();
+    size_t clean_start = 0;
+
+    for (size_t i = 0; i < string.size(); i++)
+    {
+        // Skip 8 bytes at once while none of them needs escaping
+        while (i + 8 <= string.size())
         {
-            switch (type)
+            uint64_t word = load64(data + i);
+            if (has_byte(word, '"') | has_byte(word, '\\') | has_less_than(word, 0x20))
             {
-                case Type::STRING:
-                    return string;
-                case Type::FLOATING:
-                    return std::to_string(floating);
-                case Type::INTEGER:
-                    return std::to_string(integer);
-                case Type::BOOLEAN:
-                    return boolean ? "true" : "false";
-                default:
-                    return "INVALID";
+                break;
             }
+            i += 8;
+        }
+        if (i == string.size())
+        {
+            break;
         }
 
-    protected:
-        bool parse_string(const char * data, size_t size)
+        const char c = data[i];
+        if (c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20)
         {
+            continue;
+        }
 
-            auto regex = ctre::search<"\"(.*)\"">(std::string_view(data, size + 1));
+        output.append(data + clean_start, i - clean_start);
+        clean_start = i + 1;
 
-            if (regex)
-            {
-                string = std::string(regex.get<1>().to_view());
-                type = Type::STRING;
-                return true;
-            }
+        switch (c)
+        {
+            case '"': output += "\\\""; break;
+            case '\\': output += "\\\\"; break;
+            case '\n': output += "\\n"; break;
+            case '\r': output += "\\r"; break;
+            case '\t': output += "\\t"; break;
+            default:
+                output += "\\u00";
+                output += HEX[(c >> 4) & 0xF];
+                output += HEX[c & 0xF];
+                break;
+        }
+    }
 
-            return false;
+    output.append(data + clean_start, string.size() - clean_start);
+}
+
+// Position of the first quote or backslash in [begin, end), end if none
+inline size_t find_string_end(const char * data, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        uint64_t word = load64(data + i);
+        if (has_byte(word, '"') | has_byte(word, '\\'))
+        {
+            break;
         }
+    }
 
-        bool parse_boolean(const char * data, size_t size)
+    for (; i < end; i++)
+    {
+        if (data[i] == '"' || data[i] == '\\')
         {
+            return i;
+        }
+    }
 
-            auto regex = ctre::search<"true|false|True|False|TRUE|FALSE">(std::string_view(data, size + 1));
+    return end;
+}
 
-            if (regex)
+// Position of the first quote or bracket in [begin, end), end if none
+inline size_t find_structural(const char * data, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        uint64_t word = load64(data + i);
+        if (has_byte(word, '"') | has_byte(word, '{') | has_byte(word, '}') | has_byte(word, '[') | has_byte(word, ']'))
+        {
+            break;
+        }
+    }
+
+    for (; i < end; i++)
+    {
+        const char c = data[i];
+        if (c == '"' || c == '{' || c == '}' || c == '[' || c == ']')
+        {
+            return i;
+        }
+    }
+
+    return end;
+}
+
+// Parses a whole raw value as an integer, false for anything else and for integers out of the int64_t range
+inline bool parse_integer(const std::string_view & raw, int64_t & integer)
+{
+    const char * end = raw.data() + raw.size();
+    auto result = std::from_chars(raw.data(), end, integer);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// Parses a whole raw value as a number, false for anything else
+inline bool parse_number(const std::string_view & raw, double & number)
+{
+    const char * end = raw.data() + raw.size();
+    auto result = std::from_chars(raw.data(), end, number);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+constexpr int64_t days_from_civil(int64_t year, int64_t month, int64_t day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t year_of_era = year - era * 400;
+    const int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// Fixed layout "YYYY-MM-DDTHH:MM:SS[.fraction]Z", the first 16 bytes are checked and decoded as two words
+inline bool parse_timestamp_fixed(const std::string_view & text, int64_t & nanoseconds)
+{
+    const char * data = text.data();
+    const size_t size = text.size();
+
+    if (size < 20 || (data[10] != 'T' && data[10] != 't' && data[10] != ' ') || data[16] != ':')
+    {
+        return false;
+    }
+
+    // XOR with the expected layout turns digits into 0..9 and the separators into 0
+    const uint64_t date = load64_le(data) ^ load64_le("0000-00-");
+    const uint64_t time = (load64_le(data + 8) & ~(uint64_t(0xFF) << 16)) ^ load64_le("00\0" "00:00");
+
+    const uint64_t ones = broadcast(1);
+    const uint64_t separators = (uint64_t(0xFF) << 32) | (uint64_t(0xFF) << 56);
+    const uint64_t time_separators = uint64_t(0xFF) << 40;
+
+    auto all_below_ten = [&](uint64_t word)
+    {
+        return ((word | (word + ones * 0x76)) & (ones * 0x80)) == 0;
+    };
+
+    if (!all_below_ten(date) || !all_below_ten(time) || (date & separators) || (time & time_separators))
+    {
+        return false;
+    }
+
+    // Byte k of pairs holds 10 * digit k + digit k + 1
+    const uint64_t date_pairs = (date * 0xA01) >> 8;
+    const uint64_t time_pairs = (time * 0xA01) >> 8;
+
+    const int64_t year = (date_pairs & 0xFF) * 100 + ((date_pairs >> 16) & 0xFF);
+    const int64_t month = (date_pairs >> 40) & 0xFF;
+    const int64_t day = time_pairs & 0xFF;
+    const int64_t hour = (time_pairs >> 24) & 0xFF;
+    const int64_t minute = (time_pairs >> 48) & 0xFF;
+
+    const int64_t second_high = data[17] - '0';
+    const int64_t second_low = data[18] - '0';
+
+    if (second_high < 0 || second_high > 6 || second_low < 0 || second_low > 9)
+    {
+        return false;
+    }
+
+    const int64_t second = second_high * 10 + second_low;
+
+    size_t pos = 19;
+    int64_t fraction = 0;
+
+    if (data[pos] == '.')
+    {
+        int64_t scale = 100000000;
+        for (pos++; pos < size && data[pos] >= '0' && data[pos] <= '9'; pos++)
+        {
+            fraction += (data[pos] - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    // Offsets and anything unusual go through the general parser
+    if (pos + 1 != size || (data[pos] != 'Z' && data[pos] != 'z') || data[pos - 1] == '.' ||
+        month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    {
+        return false;
+    }
+
+    nanoseconds = (days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second) * 1000000000 + fraction;
+    return true;
+}
+
+// ISO 8601 / RFC 3339 date and time (e.g. "2024-03-01T12:00:00.123Z") to nanoseconds since the epoch
+inline bool parse_timestamp(const std::string_view & text, int64_t & nanoseconds)
+{
+    if (parse_timestamp_fixed(text, nanoseconds))
+    {
+        return true;
+    }
+
+    size_t pos = 0;
+
+    auto digits = [&](size_t count, int64_t & value)
+    {
+        value = 0;
+        if (pos + count > text.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            char c = text[pos + i];
+            if (c < '0' || c > '9')
             {
-                bool value = regex.to_view() == "true" || regex.to_view() == "True" || regex.to_view() == "TRUE";
-                boolean = value;
-                type = Type::BOOLEAN;
-                return true;
+                return false;
             }
+            value = value * 10 + (c - '0');
+        }
+        pos += count;
+        return true;
+    };
+
+    auto expect = [&](char c)
+    {
+        if (pos < text.size() && text[pos] == c)
+        {
+            pos++;
+            return true;
+        }
+        return false;
+    };
+
+    int64_t year, month, day;
+    int64_t hour = 0, minute = 0, second = 0, fraction = 0, offset = 0;
+
+    if (!(digits(4, year) && expect('-') && digits(2, month) && expect('-') && digits(2, day)))
+    {
+        return false;
+    }
 
+    if (pos < text.size())
+    {
+        if (!(expect('T') || expect('t') || expect(' ')) || !(digits(2, hour) && expect(':') && digits(2, minute)))
+        {
             return false;
         }
 
-        bool parse_number(const char * data, size_t size)
+        if (expect(':'))
         {
-            auto regex = ctre::search<"-?[0-9]+\\.?[0-9]*|-?[0-9]*\\.?[0-9]+">(std::string_view(data, size + 1));
+            if (!digits(2, second))
+            {
+                return false;
+            }
 
-            if (regex)
+            if (expect('.') || expect(','))
             {
-                std::string_view number = regex.to_view();
-                if (number.find('.') != std::string_view::npos)
+                size_t start = pos;
+                int64_t scale = 100000000;
+                for (; pos < text.size() && text[pos] >= '0' && text[pos] <= '9'; pos++)
                 {
-                    floating = std::stod(std::string(number));
-                    type = Type::FLOATING;
+                    fraction += (text[pos] - '0') * scale;
+                    scale /= 10;
                 }
-                else
+                if (pos == start)
                 {
-                    integer = std::stoll(std::string(number));
-                    type = Type::INTEGER;
+                    return false;
                 }
+            }
+        }
 
-                return true;
+        if (!(expect('Z') || expect('z')) && pos < text.size())
+        {
+            int64_t sign = text[pos] == '-' ? -1 : 1;
+            int64_t offset_hours, offset_minutes = 0;
+
+            if (!(expect('+') || expect('-')) || !digits(2, offset_hours))
+            {
+                return false;
+            }
+            expect(':');
+            if (pos < text.size() && !digits(2, offset_minutes))
+            {
+                return false;
             }
 
-            return false;
+            offset = sign * (offset_hours * 3600 + offset_minutes * 60);
         }
-};
+    }
 
-/**
- * @class IJSONListener
- *
- * @brief Low level interface for JSON listeners
-*/
-struct IJSONListener
+    // Second 60 is a leap second
+    if (pos != text.size() || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    {
+        return false;
+    }
+
+    int64_t seconds = days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+    nanoseconds = seconds * 1000000000 + fraction;
+    return true;
+}
+
+// Value of each base64 character (standard and URL safe alphabets), 0xFF for anything else
+constexpr std::array<uint8_t, 256> make_base64_table()
 {
-    virtual void on_object_start() {};
-    virtual void on_object_end() {};
-    virtual void on_array_start() {};
-    virtual void on_array_end() {};
-    virtual void on_array_next_element() {};
-    virtual void on_key(const std::string_view & key) {};
-    virtual void on_value(const JSONValue & value) {};
-};
+    std::array<uint8_t, 256> table = {};
+    for (auto & entry : table)
+    {
+        entry = 0xFF;
+    }
+
+    const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (uint8_t i = 0; i < 64; i++)
+    {
+        table[static_cast<unsigned char>(alphabet[i])] = i;
+    }
+    table['-'] = 62;
+    table['_'] = 63;
+
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 256> BASE64_TABLE = make_base64_table();
+
+} // namespace detail
 
 /**
- * @class JSONListener
+ * @class Base64Decoder
  *
- * @brief A simple JSON listener that builds a aggregated key string
+ * @brief Incremental base64 decoder, input can be split anywhere (e.g. the deltas of on_partial_value)
+ *
+ * Runs of eight characters are decoded to six bytes at once through a lookup table. The JSON escape
+ * "\/" is accepted, padding is optional. decode() writes at most 3 * (size + 3) / 4 bytes.
 */
-struct JSONListener : public IJSONListener
+class Base64Decoder
 {
-    void on_object_start() override {
+public:
+
+    static constexpr size_t max_decoded_size(size_t size)
+    {
+        return 3 * ((size + 3) / 4);
+    }
+
+    /**
+     * @brief Decodes a piece of the input into out, returns the number of bytes written
+    */
+    size_t decode(const std::string_view & input, char * out)
+    {
+        const char * data = input.data();
+        const size_t size = input.size();
+        const auto & table = detail::BASE64_TABLE;
+
+        char * start = out;
+        size_t i = 0;
+
+        consumed_ += size;
+
+        while (i < size && !failed_)
+        {
+            // Fast path, whole groups of eight characters
+            if (pending_ == 0 && !escaped_ && !ended_)
+            {
+                for (; i + 8 <= size; i += 8)
+                {
+                    const unsigned char * c = reinterpret_cast<const unsigned char *>(data + i);
+                    uint64_t v0 = table[c[0]], v1 = table[c[1]], v2 = table[c[2]], v3 = table[c[3]];
+                    uint64_t v4 = table[c[4]], v5 = table[c[5]], v6 = table[c[6]], v7 = table[c[7]];
+
+                    if ((v0 | v1 | v2 | v3 | v4 | v5 | v6 | v7) & 0x80)
+                    {
+                        break;
+                    }
+
+                    uint64_t bits = (v0 << 42) | (v1 << 36) | (v2 << 30) | (v3 << 24) | (v4 << 18) | (v5 << 12) | (v6 << 6) | v7;
+                    for (size_t b = 0; b < 6; b++)
+                    {
+                        out[b] = static_cast<char>(bits >> (40 - 8 * b));
+                    }
+                    out += 6;
+                }
+
+                if (i >= size)
+                {
+                    break;
+                }
+            }
+
+            out += decode_char(data[i++], out);
+        }
+
+        return out - start;
+    }
+
+    /**
+     * @brief Flushes an unpadded tail into out at the end of the input, returns the number of bytes written
+    */
+    size_t finish(char * out)
+    {
+        size_t written = flush_quad(out);
+        failed_ = failed_ || escaped_;
+        return failed_ ? 0 : written;
+    }
+
+    /**
+     * @brief Number of input characters received so far
+    */
+    size_t consumed() const
+    {
+        return consumed_;
+    }
+
+    bool failed() const
+    {
+        return failed_;
+    }
+
+    void reset()
+    {
+        quad_ = 0;
+        pending_ = 0;
+        padding_ = 0;
+        consumed_ = 0;
+        escaped_ = false;
+        ended_ = false;
+        failed_ = false;
+    }
+
+protected:
+
+    size_t decode_char(char c, char * out)
+    {
+        if (escaped_)
+        {
+            escaped_ = false;
+            failed_ = failed_ || c != '/';
+        }
+        else if (c == '\\')
+        {
+            escaped_ = true;
+            return 0;
+        }
+
+        if (c == '=')
+        {
+            // The first padding character ends the data, a quad holds at least two characters
+            if (!ended_)
+            {
+                failed_ = failed_ || pending_ < 2;
+                ended_ = true;
+                padding_ = 3 - pending_;
+                return flush_quad(out);
+            }
+
+            failed_ = failed_ || padding_ == 0;
+            padding_ -= padding_ > 0;
+            return 0;
+        }
+
+        uint8_t value = detail::BASE64_TABLE[static_cast<unsigned char>(c)];
+        if (value == 0xFF || ended_)
+        {
+            failed_ = true;
+            return 0;
+        }
+
+        quad_ = (quad_ << 6) | value;
+        if (++pending_ < 4)
+        {
+            return 0;
+        }
+
+        out[0] = static_cast<char>(quad_ >> 16);
+        out[1] = static_cast<char>(quad_ >> 8);
+        out[2] = static_cast<char>(quad_);
+        quad_ = 0;
+        pending_ = 0;
+        return 3;
+    }
+
+    // Writes the bytes of an incomplete quad
+    size_t flush_quad(char * out)
+    {
+        failed_ = failed_ || pending_ == 1;
+
+        size_t written = pending_ > 1 ? pending_ - 1 : 0;
+        for (size_t b = 0; b < written; b++)
+        {
+            out[b] = static_cast<char>(quad_ >> (6 * pending_ - 8 * (b + 1)));
+        }
+
+        quad_ = 0;
+        pending_ = 0;
+        return written;
+    }
+
+    // State variables
+    uint32_t quad_ = 0;
+    size_t pending_ = 0;
+    size_t padding_ = 0;
+    size_t consumed_ = 0;
+    bool escaped_ = false;
+    bool ended_ = false;
+    bool failed_ = false;
+};
+
+/**
+ * @class JSONValue
+ *
+ * @brief A simple class to hold a JSON value
+*/
+struct JSONValue
+    {
+        enum class Type
+        {
+            STRING,
+            FLOATING,
+            INTEGER,
+            BOOLEAN,
+            NULL_VALUE,
+            INVALID
+        };
+
+        Type type;
+
+        std::string string;
+        union
+        {
+            double floating;
+            int64_t integer;
+            bool boolean;
+        };
+
+        JSONValue(const char * string, size_t size)
+        {
+            parse(string, size);
+        }
+
+        // Exactly the raw bytes of a value, strings include their quotes
+        explicit JSONValue(const std::string_view & raw)
+        {
+            if (raw.empty())
+            {
+                type = Type::INVALID;
+            }
+            else
+            {
+                parse(raw.data(), raw.size() - 1);
+            }
+        }
+
+        // Typed values, for decoders of binary formats
+        static JSONValue from_string(const std::string_view & string)
+        {
+            JSONValue value(Type::STRING);
+            value.string = std::string(string);
+            return value;
+        }
+
+        static JSONValue from_integer(int64_t integer)
+        {
+            JSONValue value(Type::INTEGER);
+            value.integer = integer;
+            return value;
+        }
+
+        static JSONValue from_floating(double floating)
+        {
+            JSONValue value(Type::FLOATING);
+            value.floating = floating;
+            return value;
+        }
+
+        static JSONValue from_boolean(bool boolean)
+        {
+            JSONValue value(Type::BOOLEAN);
+            value.boolean = boolean;
+            return value;
+        }
+
+        static JSONValue null()
+        {
+            return JSONValue(Type::NULL_VALUE);
+        }
+
+        /**
+         * @brief Nanoseconds since the epoch of an ISO 8601 / RFC 3339 string value
+        */
+        bool timestamp(int64_t & nanoseconds) const
+        {
+            return type == Type::STRING && detail::parse_timestamp(string, nanoseconds);
+        }
+
+        /**
+         * @brief Nanoseconds since the epoch of the raw bytes of a string value, without materializing it
+        */
+        static bool timestamp(const std::string_view & raw, int64_t & nanoseconds)
+        {
+            // Timestamps never need escaping
+            if (raw.size() < 2 || raw.front() != '"' || raw.back() != '"')
+            {
+                return false;
+            }
+
+            return detail::parse_timestamp(raw.substr(1, raw.size() - 2), nanoseconds);
+        }
+
+        /**
+         * @brief Decodes a base64 string value into out, which holds Base64Decoder::max_decoded_size(string.size()) bytes
+         *
+         * @return Number of bytes written, std::string::npos when the value is not base64
+        */
+        size_t base64(char * out) const
+        {
+            if (type != Type::STRING)
+            {
+                return std::string::npos;
+            }
+
+            return decode_base64(string, out);
+        }
+
+        /**
+         * @brief Decodes the raw bytes of a base64 string value into out without materializing the string
+        */
+        static size_t base64(const std::string_view & raw, char * out)
+        {
+            if (raw.size() < 2 || raw.front() != '"' || raw.back() != '"')
+            {
+                return std::string::npos;
+            }
+
+            return decode_base64(raw.substr(1, raw.size() - 2), out);
+        }
+
+        std::string to_string() const
+        {
+            switch (type)
+            {
+                case Type::STRING:
+                    return string;
+                case Type::FLOATING:
+                    return std::to_string(floating);
+                case Type::INTEGER:
+                    return std::to_string(integer);
+                case Type::BOOLEAN:
+                    return boolean ? "true" : "false";
+                case Type::NULL_VALUE:
+                    return "null";
+                default:
+                    return "INVALID";
+            }
+        }
+
+    protected:
+        explicit JSONValue(Type value_type)
+        : type(value_type), integer(0)
+        {
+        }
+
+        static size_t decode_base64(const std::string_view & text, char * out)
+        {
+            Base64Decoder decoder;
+            size_t size = decoder.decode(text, out);
+            size += decoder.finish(out + size);
+
+            return decoder.failed() ? std::string::npos : size;
+        }
+
+        // Classify a value, size + 1 bytes are inspected
+        void parse(const char * data, size_t size)
+        {
+            bool success = parse_string(data, size);
+            success = success || parse_number(data, size);
+            success = success || parse_boolean(data, size);
+            success = success || parse_null(data, size);
+
+            if (!success)
+            {
+                type = Type::INVALID;
+            }
+        }
+
+        bool parse_string(const char * data, size_t size)
+        {
+
+            auto regex = ctre::search<"\"(.*)\"">(std::string_view(data, size + 1));
+
+            if (regex)
+            {
+                string = std::string(regex.get<1>().to_view());
+                type = Type::STRING;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool parse_boolean(const char * data, size_t size)
+        {
+
+            auto regex = ctre::search<"true|false|True|False|TRUE|FALSE">(std::string_view(data, size + 1));
+
+            if (regex)
+            {
+                bool value = regex.to_view() == "true" || regex.to_view() == "True" || regex.to_view() == "TRUE";
+                boolean = value;
+                type = Type::BOOLEAN;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool parse_null(const char * data, size_t size)
+        {
+            auto regex = ctre::search<"null|None|NULL">(std::string_view(data, size + 1));
+
+            if (regex)
+            {
+                type = Type::NULL_VALUE;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool parse_number(const char * data, size_t size)
+        {
+            auto regex = ctre::search<"-?[0-9]+\\.?[0-9]*([eE][-+]?[0-9]+)?|-?[0-9]*\\.?[0-9]+([eE][-+]?[0-9]+)?">(std::string_view(data, size + 1));
+
+            if (regex)
+            {
+                std::string_view number = regex.to_view();
+                auto result = std::from_chars(number.data(), number.data() + number.size(), integer);
+
+                // Fractions, exponents and integers out of the int64_t range are floating
+                if (number.find_first_of(".eE") != std::string_view::npos || result.ec != std::errc())
+                {
+                    floating = std::strtod(std::string(number).c_str(), nullptr);
+                    type = Type::FLOATING;
+                }
+                else
+                {
+                    type = Type::INTEGER;
+                }
+
+                return true;
+            }
+
+            return false;
+        }
+};
+
+/**
+ * @struct StaticNode
+ *
+ * @brief A node of a JSON document parsed at compile time, see static_json
+*/
+struct StaticNode
+{
+    enum class Kind : uint8_t
+    {
+        OBJECT,
+        ARRAY,
+        VALUE
+    };
+
+    Kind kind = Kind::VALUE;
+
+    // Classification of values, as done by JSONValue
+    JSONValue::Type type = JSONValue::Type::INVALID;
+
+    // Raw key of object members and raw bytes of the node (strings include their quotes, containers are whole)
+    std::string_view key;
+    std::string_view raw;
+
+    int64_t integer = 0;
+    double floating = 0.0;
+    bool boolean = false;
+
+    // Index of the next sibling, one past the last descendant
+    size_t end = 0;
+
+    /**
+     * @brief Content of a string value, still escaped like JSONValue::string
+    */
+    constexpr std::string_view string() const
+    {
+        return type == JSONValue::Type::STRING ? raw.substr(1, raw.size() - 2) : std::string_view();
+    }
+};
+
+namespace detail
+{
+
+/**
+ * @brief Index of the node at a path in the format of FilterListener queries (e.g. "owners[1].name")
+ *
+ * Nodes are in document order, DocumentType tells the kind(), end() (next sibling) and key() of each one.
+ * The path is relative to the node at index.
+ *
+ * @return The index, std::string_view::npos if missing
+*/
+template<typename DocumentType>
+constexpr size_t find_path(const DocumentType & document, std::string_view path, size_t index = 0)
+{
+    while (!path.empty())
+    {
+        if (path[0] == '.')
+        {
+            path.remove_prefix(1);
+            continue;
+        }
+
+        bool by_position = path[0] == '[';
+        size_t position = 0;
+        std::string_view key;
+
+        if (by_position)
+        {
+            size_t close = path.find(']');
+            if (close == std::string_view::npos)
+            {
+                return std::string_view::npos;
+            }
+            for (size_t i = 1; i < close; i++)
+            {
+                position = position * 10 + (path[i] - '0');
+            }
+            path.remove_prefix(close + 1);
+        }
+        else
+        {
+            size_t size = std::min(path.find('.'), path.find('['));
+            key = path.substr(0, size);
+            path.remove_prefix(std::min(size, path.size()));
+        }
+
+        if (document.kind(index) != (by_position ? StaticNode::Kind::ARRAY : StaticNode::Kind::OBJECT))
+        {
+            return std::string_view::npos;
+        }
+
+        // Children are skipped through their end
+        size_t count = 0;
+        size_t child = index + 1;
+        for (; child < document.end(index); child = document.end(child), count++)
+        {
+            if (by_position ? count == position : document.key(child) == key)
+            {
+                break;
+            }
+        }
+
+        if (child == document.end(index))
+        {
+            return std::string_view::npos;
+        }
+        index = child;
+    }
+
+    return index;
+}
+
+// String literal usable as a template argument
+template<size_t N>
+struct StaticString
+{
+    char data[N] = {};
+
+    constexpr StaticString(const char (&string)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            data[i] = string[i];
+        }
+    }
+
+    constexpr std::string_view view() const
+    {
+        return std::string_view(data, N - 1);
+    }
+};
+
+// Not constexpr, calling it while parsing at compile time stops the compilation
+inline void invalid_static_json() {}
+
+constexpr bool static_is_space(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/**
+ * @brief Unsigned integer of up to 4096 bits, enough for the exact conversion of a decimal number to double
+*/
+struct StaticBigInteger
+{
+    static constexpr size_t LIMBS = 128;
+
+    std::array<uint32_t, LIMBS> limbs = {};
+    size_t size = 0;
+
+    constexpr StaticBigInteger(uint32_t value = 0)
+    {
+        limbs[0] = value;
+        size = (value != 0);
+    }
+
+    constexpr size_t bit_length() const
+    {
+        return (size == 0) ? 0 : (size - 1) * 32 + std::bit_width(limbs[size - 1]);
+    }
+
+    // this = this * factor + addend
+    constexpr void multiply_add(uint32_t factor, uint32_t addend)
+    {
+        uint64_t carry = addend;
+        for (size_t i = 0; i < size; i++)
+        {
+            uint64_t product = static_cast<uint64_t>(limbs[i]) * factor + carry;
+            limbs[i] = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+
+        if (carry != 0)
+        {
+            limbs[size++] = static_cast<uint32_t>(carry);
+        }
+    }
+
+    constexpr void multiply_power_of_ten(int64_t exponent)
+    {
+        for (; exponent >= 9; exponent -= 9)
+        {
+            multiply_add(1000000000, 0);
+        }
+        for (; exponent > 0; exponent--)
+        {
+            multiply_add(10, 0);
+        }
+    }
+
+    constexpr void shift_left(size_t bits)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+
+        size_t words = bits / 32;
+        size_t rest = bits % 32;
+        size_t new_size = size + words + 1;
+
+        // From the top, so every limb is read before it is written
+        for (size_t i = new_size; i-- > 0;)
+        {
+            uint64_t high = (i >= words && i - words < size) ? limbs[i - words] : 0;
+            uint64_t low = (rest != 0 && i >= words + 1 && i - words - 1 < size) ? limbs[i - words - 1] : 0;
+            limbs[i] = static_cast<uint32_t>((high << rest) | (low >> (32 - rest)));
+        }
+
+        size = new_size;
+        while (size > 0 && limbs[size - 1] == 0)
+        {
+            size--;
+        }
+    }
+
+    constexpr bool operator>=(const StaticBigInteger & other) const
+    {
+        if (size != other.size)
+        {
+            return size > other.size;
+        }
+        for (size_t i = size; i-- > 0;)
+        {
+            if (limbs[i] != other.limbs[i])
+            {
+                return limbs[i] > other.limbs[i];
+            }
+        }
+        return true;
+    }
+
+    // this = this - other, other must not be greater
+    constexpr void subtract(const StaticBigInteger & other)
+    {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            int64_t difference = static_cast<int64_t>(limbs[i]) - (i < other.size ? other.limbs[i] : 0) - borrow;
+            borrow = difference < 0;
+            limbs[i] = static_cast<uint32_t>(difference + (borrow << 32));
+        }
+
+        while (size > 0 && limbs[size - 1] == 0)
+        {
+            size--;
+        }
+    }
+};
+
+// floor(numerator * 2^shift / denominator) for quotients below 2^55, numerator keeps the remainder
+constexpr uint64_t static_divide(StaticBigInteger & numerator, StaticBigInteger denominator, int64_t shift)
+{
+    if (shift >= 0)
+    {
+        numerator.shift_left(static_cast<size_t>(shift));
+    }
+    else
+    {
+        denominator.shift_left(static_cast<size_t>(-shift));
+    }
+
+    uint64_t quotient = 0;
+    for (int bit = 54; bit >= 0; bit--)
+    {
+        StaticBigInteger scaled = denominator;
+        scaled.shift_left(bit);
+
+        if (numerator >= scaled)
+        {
+            numerator.subtract(scaled);
+            quotient |= uint64_t(1) << bit;
+        }
+    }
+
+    return quotient;
+}
+
+/**
+ * @brief Correctly rounded double of digits * 10^exponent, the same result as strtod
+ *
+ * digits are the significant digits of the integer and fraction parts, given in two pieces so the dot
+ * does not need to be removed. Out of range values are infinite or zero, like strtod.
+*/
+constexpr double static_to_double(std::string_view integer_digits, std::string_view fraction_digits, int64_t exponent, bool negative)
+{
+    // Beyond 800 significant digits only whether the rest is zero matters for rounding
+    constexpr size_t MAX_DIGITS = 800;
+
+    size_t total = integer_digits.size() + fraction_digits.size();
+    auto digit = [&](size_t k) { return (k < integer_digits.size()) ? integer_digits[k] : fraction_digits[k - integer_digits.size()]; };
+
+    size_t first = 0;
+    while (first < total && digit(first) == '0')
+    {
+        first++;
+    }
+
+    StaticBigInteger numerator;
+    uint64_t small = 0;
+    size_t count = 0;
+    bool truncated = false;
+
+    for (size_t k = first; k < total; k++)
+    {
+        if (count < MAX_DIGITS)
+        {
+            numerator.multiply_add(10, digit(k) - '0');
+            small = (count < 19) ? small * 10 + (digit(k) - '0') : small;
+            count++;
+        }
+        else
+        {
+            truncated = truncated || digit(k) != '0';
+            exponent++;
+        }
+    }
+
+    // A trailing 1 keeps the truncated value between the same two halfway points
+    if (truncated)
+    {
+        numerator.multiply_add(10, 1);
+        count++;
+        exponent--;
+    }
+
+    uint64_t sign = negative ? uint64_t(1) << 63 : 0;
+    int64_t leading_exponent = static_cast<int64_t>(count) - 1 + exponent;
+
+    if (count == 0 || leading_exponent < -325)
+    {
+        return std::bit_cast<double>(sign);
+    }
+    if (leading_exponent > 308)
+    {
+        return std::bit_cast<double>(sign | 0x7ff0000000000000);
+    }
+
+    // Exact mantissa and power of ten, one rounding
+    if (count <= 15 && exponent >= -22 && exponent <= 22)
+    {
+        double power = 1.0;
+        for (int64_t e = 0; e < (exponent < 0 ? -exponent : exponent); e++)
+        {
+            power *= 10.0;
+        }
+
+        double value = (exponent < 0) ? static_cast<double>(small) / power : static_cast<double>(small) * power;
+        return negative ? -value : value;
+    }
+
+    StaticBigInteger denominator(1);
+    if (exponent >= 0)
+    {
+        numerator.multiply_power_of_ten(exponent);
+    }
+    else
+    {
+        denominator.multiply_power_of_ten(-exponent);
+    }
+
+    // 54 bits of quotient: 53 for the mantissa and one to round, the remainder breaks ties
+    int64_t shift = 53 - static_cast<int64_t>(numerator.bit_length()) + static_cast<int64_t>(denominator.bit_length());
+    StaticBigInteger remainder = numerator;
+    uint64_t quotient = static_divide(remainder, denominator, shift);
+
+    if (quotient < (uint64_t(1) << 53))
+    {
+        shift++;
+        remainder = numerator;
+        quotient = static_divide(remainder, denominator, shift);
+    }
+
+    int64_t binary_exponent = 53 - shift;
+
+    // Subnormals round at 2^-1074
+    if (binary_exponent < -1022)
+    {
+        shift = 1075;
+        remainder = numerator;
+        quotient = static_divide(remainder, denominator, shift);
+    }
+
+    uint64_t mantissa = quotient >> 1;
+    if ((quotient & 1) != 0 && (remainder.size != 0 || (mantissa & 1) != 0))
+    {
+        mantissa++;
+    }
+
+    if (binary_exponent < -1022)
+    {
+        // A carry into bit 52 is the smallest normal number
+        return std::bit_cast<double>(sign | mantissa);
+    }
+
+    if (mantissa == (uint64_t(1) << 53))
+    {
+        mantissa >>= 1;
+        binary_exponent++;
+    }
+    if (binary_exponent > 1023)
+    {
+        return std::bit_cast<double>(sign | 0x7ff0000000000000);
+    }
+
+    return std::bit_cast<double>(sign | (static_cast<uint64_t>(binary_exponent + 1023) << 52) | (mantissa & ((uint64_t(1) << 52) - 1)));
+}
+
+/**
+ * @brief Recursive descent parser for static_json, counts the nodes when nodes is null
+*/
+class StaticJSONParser
+{
+public:
+    constexpr StaticJSONParser(std::string_view json, StaticNode * nodes)
+    : json_(json), nodes_(nodes)
+    {
+    }
+
+    constexpr size_t parse()
+    {
+        value(std::string_view());
+        skip_space();
+
+        if (pos_ != json_.size())
+        {
+            invalid_static_json();
+        }
+
+        return count_;
+    }
+
+protected:
+
+    constexpr void skip_space()
+    {
+        while (pos_ < json_.size() && static_is_space(json_[pos_]))
+        {
+            pos_++;
+        }
+    }
+
+    constexpr char peek()
+    {
+        skip_space();
+        if (pos_ >= json_.size())
+        {
+            invalid_static_json();
+            return '\0';
+        }
+        return json_[pos_];
+    }
+
+    constexpr void expect(char c)
+    {
+        if (peek() != c)
+        {
+            invalid_static_json();
+        }
+        pos_++;
+    }
+
+    constexpr std::string_view string()
+    {
+        peek();
+        size_t start = pos_;
+        expect('"');
+
+        while (pos_ < json_.size() && json_[pos_] != '"')
+        {
+            pos_ += (json_[pos_] == '\\') ? 2 : 1;
+        }
+
+        expect('"');
+        return json_.substr(start, pos_ - start);
+    }
+
+    constexpr void value(std::string_view key)
+    {
+        char c = peek();
+        size_t index = count_++;
+        size_t start = pos_;
+
+        StaticNode node;
+        node.key = key;
+
+        if (c == '{' || c == '[')
+        {
+            node.kind = (c == '{') ? StaticNode::Kind::OBJECT : StaticNode::Kind::ARRAY;
+            char close = (c == '{') ? '}' : ']';
+            pos_++;
+
+            if (peek() != close)
+            {
+                do
+                {
+                    std::string_view member_key;
+                    if (c == '{')
+                    {
+                        member_key = string();
+                        expect(':');
+                    }
+                    value(member_key);
+                }
+                while (peek() == ',' && ++pos_);
+            }
+
+            expect(close);
+        }
+        else if (c == '"')
+        {
+            string();
+            node.type = JSONValue::Type::STRING;
+        }
+        else
+        {
+            scalar(node);
+        }
+
+        node.raw = json_.substr(start, pos_ - start);
+        node.end = count_;
+
+        if (nodes_ != nullptr)
+        {
+            nodes_[index] = node;
+        }
+    }
+
+    constexpr void scalar(StaticNode & node)
+    {
+        size_t start = pos_;
+        while (pos_ < json_.size() && !static_is_space(json_[pos_]) && json_[pos_] != ',' && json_[pos_] != '}' && json_[pos_] != ']')
+        {
+            pos_++;
+        }
+
+        std::string_view text = json_.substr(start, pos_ - start);
+
+        if (text == "true" || text == "True" || text == "TRUE" || text == "false" || text == "False" || text == "FALSE")
+        {
+            node.type = JSONValue::Type::BOOLEAN;
+            node.boolean = text[0] == 't' || text[0] == 'T';
+        }
+        else if (text == "null" || text == "None" || text == "NULL")
+        {
+            node.type = JSONValue::Type::NULL_VALUE;
+        }
+        else
+        {
+            number(text, node);
+        }
+    }
+
+    static constexpr bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    // Classified as JSONValue does: fractions, exponents and integers out of the int64_t range are floating
+    constexpr void number(std::string_view text, StaticNode & node)
+    {
+        size_t i = 0;
+        bool negative = i < text.size() && text[i] == '-';
+        i += negative;
+
+        size_t start = i;
+        for (; i < text.size() && is_digit(text[i]); i++)
+        {
+        }
+        std::string_view integer_digits = text.substr(start, i - start);
+
+        std::string_view fraction_digits;
+        bool is_floating = false;
+
+        if (i < text.size() && text[i] == '.')
+        {
+            is_floating = true;
+            start = ++i;
+            for (; i < text.size() && is_digit(text[i]); i++)
+            {
+            }
+            fraction_digits = text.substr(start, i - start);
+        }
+
+        int64_t exponent = 0;
+
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+        {
+            is_floating = true;
+            i++;
+            bool negative_exponent = i < text.size() && text[i] == '-';
+            i += (i < text.size() && (text[i] == '-' || text[i] == '+'));
+
+            // Saturated, far beyond the range of double either way
+            start = i;
+            for (; i < text.size() && is_digit(text[i]); i++)
+            {
+                exponent = std::min<int64_t>(exponent * 10 + (text[i] - '0'), 100000);
+            }
+
+            if (i == start)
+            {
+                invalid_static_json();
+            }
+            exponent = negative_exponent ? -exponent : exponent;
+        }
+
+        if ((integer_digits.empty() && fraction_digits.empty()) || i != text.size())
+        {
+            invalid_static_json();
+        }
+
+        if (!is_floating)
+        {
+            // Magnitude up to 2^63 for negative numbers, 2^63 - 1 otherwise
+            uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + negative;
+            uint64_t magnitude = 0;
+
+            for (char c : integer_digits)
+            {
+                uint64_t digit = c - '0';
+                if (magnitude > (limit - digit) / 10)
+                {
+                    is_floating = true;
+                    break;
+                }
+                magnitude = magnitude * 10 + digit;
+            }
+
+            if (!is_floating)
+            {
+                node.type = JSONValue::Type::INTEGER;
+                node.integer = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+                return;
+            }
+        }
+
+        node.type = JSONValue::Type::FLOATING;
+        node.floating = static_to_double(integer_digits, fraction_digits, exponent - static_cast<int64_t>(fraction_digits.size()), negative);
+    }
+
+    std::string_view json_;
+    StaticNode * nodes_;
+    size_t pos_ = 0;
+    size_t count_ = 0;
+};
+
+} // namespace detail
+
+/**
+ * @class StaticJSON
+ *
+ * @brief A JSON document parsed at compile time into a flat array of nodes in document order
+ *
+ * Children follow their container and StaticNode::end jumps to the next sibling. Strings and keys
+ * are views into the document, still escaped.
+*/
+template<size_t SIZE>
+struct StaticJSON
+{
+    std::array<StaticNode, SIZE> nodes;
+
+    constexpr const StaticNode & root() const
+    {
+        return nodes[0];
+    }
+
+    /**
+     * @brief Node at a path in the format of FilterListener queries (e.g. "owners[1].name"), null if missing
+    */
+    constexpr const StaticNode * find(std::string_view path) const
+    {
+        size_t index = detail::find_path(*this, path);
+        return index < SIZE ? &nodes[index] : nullptr;
+    }
+
+    constexpr StaticNode::Kind kind(size_t index) const
+    {
+        return nodes[index].kind;
+    }
+
+    constexpr size_t end(size_t index) const
+    {
+        return nodes[index].end;
+    }
+
+    constexpr std::string_view key(size_t index) const
+    {
+        return nodes[index].key.substr(1, nodes[index].key.size() - 2);
+    }
+};
+
+template<detail::StaticString json>
+consteval auto parse_static_json()
+{
+    constexpr size_t size = detail::StaticJSONParser(json.view(), nullptr).parse();
+
+    StaticJSON<size> result = {};
+    detail::StaticJSONParser(json.view(), result.nodes.data()).parse();
+    return result;
+}
+
+/**
+ * @brief A JSON string literal parsed at compile time, e.g. static_json<R"({"port": 8080})">.find("port")->integer
+ *
+ * Invalid JSON stops the compilation.
+*/
+template<detail::StaticString json>
+inline constexpr auto static_json = parse_static_json<json>();
+
+/**
+ * @class IJSONListener
+ *
+ * @brief Low level interface for JSON listeners
+*/
+struct IJSONListener
+{
+    virtual void on_object_start() {};
+    virtual void on_object_end() {};
+    virtual void on_array_start() {};
+    virtual void on_array_end() {};
+    virtual void on_array_next_element() {};
+    virtual void on_key(const std::string_view & key) {};
+    virtual void on_value(const JSONValue & value) {};
+    virtual void on_document_end() {};
+
+    // Provisional slice of a string value that is still being received (raw bytes, without quotes)
+    virtual void on_partial_value(const std::string_view & delta) {};
+
+    // Raw bytes of a value as found in the input (strings include their quotes), only valid during the call.
+    // Listeners that can work on the bytes override it to skip building a JSONValue.
+    virtual void on_raw_value(const std::string_view & raw) { on_value(JSONValue(raw)); };
+};
+
+/**
+ * @class JSONListener
+ *
+ * @brief A simple JSON listener that builds a aggregated key string
+*/
+struct JSONListener : public IJSONListener
+{
+    void on_object_start() override {
+
+        aggregate_key_ += (aggregate_key_.size() ? "." : "");
+        if (key_.empty())
+        {
+            aggregate_key_ += "_";
+        }
+        else
+        {
+            aggregate_key_ += std::string(key_.data(), key_.size());
+        }
+
+        key_.clear();
+    };
+
+    void on_object_end() override {
+        size_t pos = aggregate_key_.rfind(".");
+
+        if (pos != std::string::npos)
+        {
+            aggregate_key_ = aggregate_key_.substr(0, pos);
+        }
+        else
+        {
+            aggregate_key_.clear();
+        }
+    };
+
+    void on_array_start() override {
+
+        array_depth_.push_back(0);
+
+        aggregate_key_ += (aggregate_key_.size() ? "." : "");
+
+        if (key_.empty())
+        {
+            aggregate_key_ += "_";
+        }
+        else
+        {
+            aggregate_key_ += std::string(key_.data(), key_.size());
+        }
+
+        aggregate_key_ += "[" + std::to_string(array_depth_.back()) + "]";
+
+        key_.clear();
+    };
+
+    void on_array_end() override {
+        array_depth_.pop_back();
+
+        size_t pos = aggregate_key_.rfind(".");
+
+        if (pos != std::string::npos)
+        {
+            aggregate_key_ = aggregate_key_.substr(0, pos);
+        }
+        else
+        {
+            aggregate_key_.clear();
+        }
+    };
+
+    void on_array_next_element() override {
+        array_depth_.back()++;
+
+        aggregate_key_ = aggregate_key_.substr(0, aggregate_key_.rfind("[")) + "[" + std::to_string(array_depth_.back()) + "]";
+    };
+
+    void on_key(const std::string_view& string) override {
+        key_ = std::string(string.data(), string.size());
+    };
+
+    void on_value(const JSONValue & /* value */) override {
+        if(!key_.empty())
+        {
+            // Got a key and a value
+            key_.clear();
+        }
+    };
+
+    void on_document_end() override {
+        // Next document starts from a clean path
+        key_.clear();
+        aggregate_key_.clear();
+        array_depth_.clear();
+    };
+
+    /**
+     * @brief Current open path, in the same format matched by FilterListener (e.g. "owners[1].name")
+    */
+    std::string path() const
+    {
+        std::string query;
+        build_path(query);
+        return query;
+    }
+
+protected:
+
+    /**
+     * @brief Writes path() into query, reusing its storage
+    */
+    void build_path(std::string & query) const
+    {
+        query = aggregate_key_;
+
+        // Array elements have no key
+        if (!key_.empty())
+        {
+            query += '.';
+            query += key_;
+        }
+
+        // Find and replace "_."
+        size_t pos = query.find("_.");
+        while (pos != std::string::npos)
+        {
+            query.replace(pos, 2, "");
+            pos = query.find("_.");
+        }
+
+        // Arrays nested in arrays have no key either, "a[0]._[1]" is "a[0][1]"
+        pos = query.find("._[");
+        while (pos != std::string::npos)
+        {
+            query.replace(pos, 2, "");
+            pos = query.find("._[", pos);
+        }
+    }
+
+    /**
+     * @brief JSON text of a value received without its raw bytes (strings are quoted, not escaped)
+    */
+    static std::string raw_text(const JSONValue & value)
+    {
+        if (value.type == JSONValue::Type::STRING)
+        {
+            return "\"" + value.to_string() + "\"";
+        }
+        if (value.type == JSONValue::Type::FLOATING && std::isfinite(value.floating))
+        {
+            // Shortest text that reads back as the same double
+            std::array<char, 32> number;
+            auto result = std::to_chars(number.data(), number.data() + number.size(), value.floating);
+            return std::string(number.data(), result.ptr - number.data());
+        }
+        return value.to_string();
+    }
+
+    std::string key_;
+    std::string aggregate_key_;
+    std::vector<size_t> array_depth_;
+};
+
+/**
+ * @class PathValueListener
+ *
+ * @brief A JSON listener that receives every value as raw JSON text together with its path
+ *
+ * Parsed values keep their raw bytes and typed values (binary decoders) are converted by raw_text(), so
+ * derived listeners only implement on_path_value(). The path is built into a reused buffer.
+*/
+struct PathValueListener : public JSONListener
+{
+    void on_raw_value(const std::string_view & raw) override {
+        build_path(path_);
+        on_path_value(path_, raw);
+
+        // Got a key and a value
+        key_.clear();
+    }
+
+    void on_value(const JSONValue & value) override {
+        build_path(path_);
+        on_path_value(path_, raw_text(value));
+
+        JSONListener::on_value(value);
+    }
+
+protected:
+
+    virtual void on_path_value(const std::string_view & path, const std::string_view & raw) = 0;
+
+    std::string path_;
+};
+
+/**
+ * @class MatchListener
+ *
+ * @brief A PathValueListener that only receives the values at the paths matching a filter, through on_match()
+*/
+template<CTRE_REGEX_INPUT_TYPE filter>
+struct MatchListener : public PathValueListener
+{
+protected:
+
+    void on_path_value(const std::string_view & path, const std::string_view & raw) override {
+        if (ctre::match<filter>(path))
+        {
+            on_match(path, raw);
+        }
+    }
+
+    virtual void on_match(const std::string_view & path, const std::string_view & raw) = 0;
+};
+
+/**
+ * @class FilterListener
+ *
+ * @brief A JSON listener that filters keys based on a string and calls a callback on match
+*/
+template<CTRE_REGEX_INPUT_TYPE filter>
+struct FilterListener : public JSONListener
+{
+    using CallBackType = std::function<void(const std::string_view &, const JSONValue &, const std::vector<size_t>&)>;
+    using PartialCallBackType = std::function<void(const std::string_view &, const std::string_view &, const std::vector<size_t>&)>;
+
+    FilterListener(CallBackType callback)
+    : callback_(callback)
+    {
+    }
+
+    FilterListener(CallBackType callback, PartialCallBackType partial_callback)
+    : callback_(callback)
+    , partial_callback_(partial_callback)
+    {
+    }
+
+    void on_value(const JSONValue & value) override {
+
+        std::string query = path();
+
+        if (ctre::match<filter>(std::string_view(query)))
+        {
+            callback_(query, value, array_depth_);
+        }
+
+        JSONListener::on_value(value);
+    }
+
+    void on_raw_value(const std::string_view & raw) override {
+
+        // The value is only classified when the path matches
+        std::string query = path();
+
+        if (ctre::match<filter>(std::string_view(query)))
+        {
+            callback_(query, JSONValue(raw), array_depth_);
+        }
+
+        // Got a key and a value
+        key_.clear();
+    }
+
+    void on_partial_value(const std::string_view & delta) override {
+
+        if (partial_callback_)
+        {
+            std::string query = path();
+
+            if (ctre::match<filter>(std::string_view(query)))
+            {
+                partial_callback_(query, delta, array_depth_);
+            }
+        }
+    }
+
+protected:
+
+    // const std::string filter_;
+
+    CallBackType callback_;
+    PartialCallBackType partial_callback_;
+};
+
+/**
+ * @struct Aggregate
+ *
+ * @brief Count, sum, minimum and maximum of a set of numbers, partial aggregates can be merged
+*/
+struct Aggregate
+{
+    size_t count = 0;
+    double sum = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double value)
+    {
+        count++;
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    void add(const double * values, size_t size)
+    {
+        // Independent lanes so the compiler can keep them in vector registers
+        constexpr size_t LANES = 4;
+        double lane_sum[LANES] = {};
+        double lane_min[LANES] = {min, min, min, min};
+        double lane_max[LANES] = {max, max, max, max};
+
+        size_t i = 0;
+        for (; i + LANES <= size; i += LANES)
+        {
+            for (size_t l = 0; l < LANES; l++)
+            {
+                lane_sum[l] += values[i + l];
+                lane_min[l] = values[i + l] < lane_min[l] ? values[i + l] : lane_min[l];
+                lane_max[l] = values[i + l] > lane_max[l] ? values[i + l] : lane_max[l];
+            }
+        }
+
+        for (size_t l = 0; l < LANES; l++)
+        {
+            sum += lane_sum[l];
+            min = std::min(min, lane_min[l]);
+            max = std::max(max, lane_max[l]);
+        }
+
+        count += i;
+
+        for (; i < size; i++)
+        {
+            add(values[i]);
+        }
+    }
+
+    void merge(const Aggregate & other)
+    {
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    double mean() const
+    {
+        return count ? sum / count : 0.0;
+    }
+};
+
+/**
+ * @class AggregateListener
+ *
+ * @brief A JSON listener that folds the numbers found at the paths matching a filter into an Aggregate
+ *
+ * Numbers are parsed straight from the raw bytes, without building a JSONValue, and folded in batches.
+ * Other values at matching paths are ignored.
+*/
+template<CTRE_REGEX_INPUT_TYPE filter>
+struct AggregateListener : public MatchListener<filter>
+{
+    static constexpr size_t BATCH_SIZE = 64;
+
+    /**
+     * @brief Aggregate of all the numbers received so far
+    */
+    Aggregate aggregate() const
+    {
+        Aggregate result = aggregate_;
+        result.add(batch_.data(), batch_size_);
+        return result;
+    }
+
+    void reset()
+    {
+        aggregate_ = Aggregate();
+        batch_size_ = 0;
+    }
+
+protected:
+
+    void on_match(const std::string_view & /* path */, const std::string_view & raw) override
+    {
+        double number;
+
+        if (detail::parse_number(raw, number))
+        {
+            push(number);
+        }
+    }
+
+    void push(double number)
+    {
+        batch_[batch_size_++] = number;
+
+        if (batch_size_ == BATCH_SIZE)
+        {
+            aggregate_.add(batch_.data(), batch_size_);
+            batch_size_ = 0;
+        }
+    }
+
+    Aggregate aggregate_;
+    std::array<double, BATCH_SIZE> batch_;
+    size_t batch_size_ = 0;
+};
+
+/**
+ * @class QuantileSketch
+ *
+ * @brief KLL sketch answering quantile queries over a stream of numbers in bounded memory, sketches can be merged
+ *
+ * Values are kept in compactors, one per level, items at level h stand for 2^h values. A full compactor
+ * is sorted and every other item is promoted to the next level. Capacities decay geometrically from the
+ * top level down so the sketch holds about 3 * K items whatever the length of the stream, with a rank
+ * error around 1.7 / K.
+*/
+template<size_t K = 200>
+class QuantileSketch
+{
+public:
+    static_assert(K >= 8, "K must be at least 8");
+
+    void add(double value)
+    {
+        add(&value, 1);
+    }
+
+    void add(const double * values, size_t size)
+    {
+        count_ += size;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            min_ = std::min(min_, values[i]);
+            max_ = std::max(max_, values[i]);
+        }
+
+        if (levels_.empty())
+        {
+            levels_.emplace_back();
+        }
+
+        levels_[0].insert(levels_[0].end(), values, values + size);
+        compress();
+    }
+
+    void merge(const QuantileSketch & other)
+    {
+        if (levels_.size() < other.levels_.size())
+        {
+            levels_.resize(other.levels_.size());
+        }
+
+        for (size_t h = 0; h < other.levels_.size(); h++)
+        {
+            levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+        }
+
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+
+        compress();
+    }
+
+    /**
+     * @brief Approximate value of rank q * count(), q in [0, 1], NaN when empty
+    */
+    double quantile(double q) const
+    {
+        if (count_ == 0)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (q <= 0.0)
+        {
+            return min_;
+        }
+        if (q >= 1.0)
+        {
+            return max_;
+        }
+
+        std::vector<std::pair<double, uint64_t>> weighted;
+        uint64_t total = 0;
+
+        for (size_t h = 0; h < levels_.size(); h++)
+        {
+            for (double value : levels_[h])
+            {
+                weighted.emplace_back(value, uint64_t(1) << h);
+                total += uint64_t(1) << h;
+            }
+        }
+
+        std::sort(weighted.begin(), weighted.end());
+
+        double target = q * static_cast<double>(total);
+        uint64_t cumulative = 0;
+
+        for (const auto & [value, weight] : weighted)
+        {
+            cumulative += weight;
+            if (static_cast<double>(cumulative) >= target)
+            {
+                return value;
+            }
+        }
+
+        return max_;
+    }
+
+    uint64_t count() const
+    {
+        return count_;
+    }
+
+    /**
+     * @brief Number of values held, bounded by about 3 * K
+    */
+    size_t size() const
+    {
+        size_t result = 0;
+        for (const auto & level : levels_)
+        {
+            result += level.size();
+        }
+        return result;
+    }
+
+    void clear()
+    {
+        levels_.clear();
+        count_ = 0;
+        min_ = std::numeric_limits<double>::infinity();
+        max_ = -std::numeric_limits<double>::infinity();
+    }
+
+protected:
+
+    size_t capacity(size_t level) const
+    {
+        size_t depth = levels_.size() - 1 - level;
+        return std::max<size_t>(2, static_cast<size_t>(std::ceil(K * std::pow(2.0 / 3.0, static_cast<double>(depth)))));
+    }
+
+    void compress()
+    {
+        for (size_t h = 0; h < levels_.size(); h++)
+        {
+            if (levels_[h].size() < capacity(h))
+            {
+                continue;
+            }
+
+            if (h + 1 == levels_.size())
+            {
+                levels_.emplace_back();
+            }
+
+            std::vector<double> & level = levels_[h];
+            std::sort(level.begin(), level.end());
+
+            // An odd item out stays at this level
+            size_t pairs = level.size() / 2;
+            double leftover = level.back();
+
+            // Random offset keeps the promoted half unbiased
+            random_ += 0x9e3779b97f4a7c15ULL;
+            size_t offset = detail::mix64(random_) & 1;
+
+            for (size_t i = 0; i < pairs; i++)
+            {
+                levels_[h + 1].push_back(level[2 * i + offset]);
+            }
+
+            bool odd = level.size() % 2;
+            level.clear();
+            if (odd)
+            {
+                level.push_back(leftover);
+            }
+        }
+    }
+
+    std::vector<std::vector<double>> levels_;
+    uint64_t count_ = 0;
+    double min_ = std::numeric_limits<double>::infinity();
+    double max_ = -std::numeric_limits<double>::infinity();
+    uint64_t random_ = 0;
+};
+
+/**
+ * @class QuantileListener
+ *
+ * @brief A JSON listener that feeds the numbers at the paths matching a filter into a QuantileSketch
+ *
+ * Numbers are parsed straight from the raw bytes and added to the sketch in batches.
+*/
+template<CTRE_REGEX_INPUT_TYPE filter, size_t K = 200>
+struct QuantileListener : public MatchListener<filter>
+{
+    static constexpr size_t BATCH_SIZE = 64;
+
+    double quantile(double q)
+    {
+        flush();
+        return sketch_.quantile(q);
+    }
+
+    /**
+     * @brief Sketch of all the numbers received so far
+    */
+    const QuantileSketch<K> & sketch()
+    {
+        flush();
+        return sketch_;
+    }
+
+    void merge(QuantileListener & other)
+    {
+        flush();
+        sketch_.merge(other.sketch());
+    }
+
+    void reset()
+    {
+        sketch_.clear();
+        batch_size_ = 0;
+    }
+
+protected:
+
+    void on_match(const std::string_view & /* path */, const std::string_view & raw) override
+    {
+        double number;
+
+        if (detail::parse_number(raw, number))
+        {
+            push(number);
+        }
+    }
+
+    void push(double number)
+    {
+        batch_[batch_size_++] = number;
+
+        if (batch_size_ == BATCH_SIZE)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        sketch_.add(batch_.data(), batch_size_);
+        batch_size_ = 0;
+    }
+
+    QuantileSketch<K> sketch_;
+    std::array<double, BATCH_SIZE> batch_;
+    size_t batch_size_ = 0;
+};
+
+/**
+ * @class StringInterner
+ *
+ * @brief Maps strings to dense ids with an open addressing hash table, strings are stored once in an arena
+*/
+class StringInterner
+{
+public:
+    static constexpr uint32_t NOT_FOUND = std::numeric_limits<uint32_t>::max();
+
+    StringInterner()
+    : slots_(16, NOT_FOUND)
+    {
+    }
+
+    uint32_t intern(const std::string_view & string)
+    {
+        uint64_t hash = detail::hash_bytes(string.data(), string.size());
+        size_t slot = probe(string, hash);
+
+        if (slots_[slot] != NOT_FOUND)
+        {
+            return slots_[slot];
+        }
+
+        uint32_t id = static_cast<uint32_t>(entries_.size());
+        entries_.push_back(Entry{arena_.size(), string.size(), hash});
+        arena_.append(string.data(), string.size());
+        slots_[slot] = id;
+
+        // Keep the load factor under 1/2
+        if (2 * entries_.size() > slots_.size())
+        {
+            rehash();
+        }
+
+        return id;
+    }
+
+    uint32_t find(const std::string_view & string) const
+    {
+        return slots_[probe(string, detail::hash_bytes(string.data(), string.size()))];
+    }
+
+    std::string_view view(uint32_t id) const
+    {
+        const Entry & entry = entries_[id];
+        return std::string_view(arena_.data() + entry.offset, entry.size);
+    }
+
+    size_t size() const
+    {
+        return entries_.size();
+    }
+
+    void clear()
+    {
+        entries_.clear();
+        arena_.clear();
+        slots_.assign(16, NOT_FOUND);
+    }
+
+protected:
+
+    struct Entry
+    {
+        size_t offset;
+        size_t size;
+        uint64_t hash;
+    };
+
+    // Slot holding string, or the empty slot where it would go
+    size_t probe(const std::string_view & string, uint64_t hash) const
+    {
+        size_t mask = slots_.size() - 1;
+        size_t slot = hash & mask;
+
+        while (slots_[slot] != NOT_FOUND)
+        {
+            const Entry & entry = entries_[slots_[slot]];
+            if (entry.hash == hash && view(slots_[slot]) == string)
+            {
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        return slot;
+    }
+
+    void rehash()
+    {
+        slots_.assign(slots_.size() * 2, NOT_FOUND);
+        size_t mask = slots_.size() - 1;
+
+        for (uint32_t id = 0; id < entries_.size(); id++)
+        {
+            size_t slot = entries_[id].hash & mask;
+            while (slots_[slot] != NOT_FOUND)
+            {
+                slot = (slot + 1) & mask;
+            }
+            slots_[slot] = id;
+        }
+    }
+
+    std::vector<Entry> entries_;
+    std::string arena_;
+    std::vector<uint32_t> slots_;
+};
+
+/**
+ * @class GroupByListener
+ *
+ * @brief A JSON listener that groups records (documents) by the values at some paths and aggregates the numbers at another
+ *
+ * Equivalent to `SELECT keys..., COUNT(*), SUM/MIN/MAX/AVG(value) GROUP BY keys...` over a stream of records
+ * such as NDJSON. Paths are exact (e.g. "http.status"), key values are kept as their raw JSON text (strings
+ * with quotes) and missing keys group as an empty string. Group keys are interned in a StringInterner.
+ * Streams can be split in shards parsed by different threads, each with its own listener, and the
+ * partial results combined with merge().
+*/
+class GroupByListener : public PathValueListener
+{
+public:
+    using CallBackType = std::function<void(const std::vector<std::string_view> &, size_t, const Aggregate &)>;
+
+    GroupByListener(std::initializer_list<std::string_view> key_paths, const std::string_view & value_path)
+    : value_path_(value_path)
+    {
+        for (const auto & key_path : key_paths)
+        {
+            key_paths_.push_back(std::string(key_path));
+        }
+        keys_.resize(key_paths_.size());
+    }
+
+    void on_document_end() override {
+        // Group key is the raw text of each key joined by a unit separator
+        record_key_.clear();
+        for (size_t k = 0; k < keys_.size(); k++)
+        {
+            record_key_ += keys_[k];
+            record_key_ += GROUP_SEPARATOR;
+            keys_[k].clear();
+        }
+
+        uint32_t group = group_of(record_key_);
+        records_[group]++;
+        if (has_value_)
+        {
+            aggregates_[group].add(value_);
+        }
+        has_value_ = false;
+
+        JSONListener::on_document_end();
+    }
+
+    void merge(const GroupByListener & other)
+    {
+        for (uint32_t other_group = 0; other_group < other.groups_.size(); other_group++)
+        {
+            uint32_t group = group_of(other.groups_.view(other_group));
+            records_[group] += other.records_[other_group];
+            aggregates_[group].merge(other.aggregates_[other_group]);
+        }
+    }
+
+    size_t size() const
+    {
+        return groups_.size();
+    }
+
+    /**
+     * @brief Calls callback with the key values, the number of records and the aggregate of each group
+    */
+    void for_each(CallBackType callback) const
+    {
+        std::vector<std::string_view> keys;
+
+        for (uint32_t group = 0; group < groups_.size(); group++)
+        {
+            keys.clear();
+            std::string_view joined = groups_.view(group);
+
+            for (size_t k = 0; k < key_paths_.size(); k++)
+            {
+                size_t end = joined.find(GROUP_SEPARATOR);
+                keys.push_back(joined.substr(0, end));
+                joined.remove_prefix(end + 1);
+            }
+
+            callback(keys, records_[group], aggregates_[group]);
+        }
+    }
+
+protected:
+
+    static constexpr char GROUP_SEPARATOR = '\x1f';
+
+    void on_path_value(const std::string_view & path, const std::string_view & raw) override
+    {
+        for (size_t k = 0; k < key_paths_.size(); k++)
+        {
+            if (path == key_paths_[k])
+            {
+                keys_[k].assign(raw.data(), raw.size());
+            }
+        }
+
+        if (path == value_path_)
+        {
+            has_value_ = detail::parse_number(raw, value_);
+        }
+    }
+
+    uint32_t group_of(const std::string_view & key)
+    {
+        uint32_t group = groups_.intern(key);
+        if (group == records_.size())
+        {
+            records_.push_back(0);
+            aggregates_.emplace_back();
+        }
+        return group;
+    }
+
+    std::vector<std::string> key_paths_;
+    std::string value_path_;
+
+    // Current record
+    std::vector<std::string> keys_;
+    double value_ = 0.0;
+    bool has_value_ = false;
+    std::string record_key_;
+
+    // Results, indexed by group id
+    StringInterner groups_;
+    std::vector<size_t> records_;
+    std::vector<Aggregate> aggregates_;
+};
+
+/**
+ * @class WindowListener
+ *
+ * @brief A JSON listener that aggregates records (documents) into time windows and reports each window when it closes
+ *
+ * Windows are `size` long and start every `slide` (tumbling when slide == size), all times in milliseconds.
+ * The timestamp of a record is an integer number of milliseconds since the epoch or an ISO 8601 string, the
+ * value at value_path is folded into the Aggregate of every window holding the record. The watermark trails
+ * the largest timestamp seen by `lateness`: windows ending at or before it are reported and dropped, so the
+ * number of open windows is bounded by (size + lateness) / slide + 1, and records falling only in closed
+ * windows are counted as late. With slide > size (hopping windows with gaps) records falling between two
+ * windows belong to none and are counted apart, by gaps(), as are records whose window bounds do not fit in
+ * int64_t. flush() reports the windows still open at the end of the stream. A size or slide below one
+ * millisecond is clamped to one, a negative lateness to zero.
+*/
+class WindowListener : public PathValueListener
+{
+public:
+    using CallBackType = std::function<void(int64_t, int64_t, size_t, const Aggregate &)>;
+
+    WindowListener(const std::string_view & timestamp_path, const std::string_view & value_path,
+        int64_t size, int64_t slide, int64_t lateness, CallBackType callback)
+    : timestamp_path_(timestamp_path), value_path_(value_path), callback_(callback)
+    {
+        // Windows are at least one millisecond long and apart
+        size_ = std::max<int64_t>(size, 1);
+        slide_ = std::max<int64_t>(slide, 1);
+        lateness_ = std::max<int64_t>(lateness, 0);
+    }
+
+    void on_document_end() override {
+        if (has_timestamp_)
+        {
+            add(timestamp_);
+        }
+        has_timestamp_ = false;
+        has_value_ = false;
+
+        JSONListener::on_document_end();
+    }
+
+    /**
+     * @brief Reports all the open windows, at the end of the stream
+     *
+     * The watermark starts over, so the listener can take a new stream. The counters are kept.
+    */
+    void flush()
+    {
+        close(std::numeric_limits<int64_t>::max());
+        watermark_ = std::numeric_limits<int64_t>::min();
+    }
+
+    /**
+     * @brief Drops the open windows without reporting them and clears the watermark and the counters
+    */
+    void reset()
+    {
+        windows_.clear();
+        watermark_ = std::numeric_limits<int64_t>::min();
+        late_ = 0;
+        gaps_ = 0;
+        has_timestamp_ = false;
+        has_value_ = false;
+    }
+
+    int64_t watermark() const
+    {
+        return watermark_;
+    }
+
+    size_t late() const
+    {
+        return late_;
+    }
+
+    /**
+     * @brief Records between two windows, only when slide > size
+    */
+    size_t gaps() const
+    {
+        return gaps_;
+    }
+
+    size_t open_windows() const
+    {
+        return windows_.size();
+    }
+
+protected:
+
+    struct Window
+    {
+        int64_t start;
+        size_t records;
+        Aggregate values;
+    };
+
+    void on_path_value(const std::string_view & path, const std::string_view & raw) override
+    {
+        if (path == timestamp_path_)
+        {
+            has_timestamp_ = parse_time(raw, timestamp_);
+        }
+        if (path == value_path_)
+        {
+            has_value_ = detail::parse_number(raw, value_);
+        }
+    }
+
+    static bool parse_time(const std::string_view & raw, int64_t & milliseconds)
+    {
+        if (raw.size() >= 2 && raw.front() == '"')
+        {
+            int64_t nanoseconds;
+            if (!JSONValue::timestamp(raw, nanoseconds))
+            {
+                return false;
+            }
+            milliseconds = floor_div(nanoseconds, 1000000);
+            return true;
+        }
+
+        const char * end = raw.data() + raw.size();
+        auto result = std::from_chars(raw.data(), end, milliseconds);
+        return result.ec == std::errc() && result.ptr == end;
+    }
+
+    static int64_t floor_div(int64_t value, int64_t divisor)
+    {
+        int64_t quotient = value / divisor;
+        return quotient - ((value % divisor != 0) && ((value < 0) != (divisor < 0)));
+    }
+
+    // Bound arithmetic, false instead of overflowing int64_t
+    static bool checked_add(int64_t a, int64_t b, int64_t & result)
+    {
+        if ((b > 0 && a > std::numeric_limits<int64_t>::max() - b) || (b < 0 && a < std::numeric_limits<int64_t>::min() - b))
+        {
+            return false;
+        }
+        result = a + b;
+        return true;
+    }
+
+    static bool checked_sub(int64_t a, int64_t b, int64_t & result)
+    {
+        if ((b < 0 && a > std::numeric_limits<int64_t>::max() + b) || (b > 0 && a < std::numeric_limits<int64_t>::min() + b))
+        {
+            return false;
+        }
+        result = a - b;
+        return true;
+    }
+
+    // factor is positive
+    static bool checked_mul(int64_t a, int64_t factor, int64_t & result)
+    {
+        if (a > std::numeric_limits<int64_t>::max() / factor || a < std::numeric_limits<int64_t>::min() / factor)
+        {
+            return false;
+        }
+        result = a * factor;
+        return true;
+    }
+
+    void add(int64_t timestamp)
+    {
+        int64_t latest;
+        int64_t latest_end;
+
+        // Windows whose bounds do not fit in int64_t cannot be reported, their records are in no window
+        if (!checked_mul(floor_div(timestamp, slide_), slide_, latest) || !checked_add(latest, size_, latest_end))
+        {
+            gaps_++;
+            return;
+        }
+
+        // Between two windows, not in any window whether open or closed
+        bool in_gap = latest_end <= timestamp;
+        bool accepted = false;
+
+        // Every window [start, start + size) holding the timestamp, latest first. Earlier windows end earlier,
+        // so start + size cannot overflow
+        for (int64_t start = latest; start + size_ > timestamp; )
+        {
+            if (start + size_ <= watermark_)
+            {
+                break;
+            }
+
+            auto window = std::lower_bound(windows_.begin(), windows_.end(), start, [](const Window & w, int64_t s)
+            {
+                return w.start < s;
+            });
+            if (window == windows_.end() || window->start != start)
+            {
+                window = windows_.insert(window, Window{start, 0, Aggregate()});
+            }
+
+            window->records++;
+            if (has_value_)
+            {
+                window->values.add(value_);
+            }
+            accepted = true;
+
+            if (!checked_sub(start, slide_, start))
+            {
+                break;
+            }
+        }
+
+        gaps_ += in_gap;
+        late_ += !accepted && !in_gap;
+
+        // Below the lowest representable watermark nothing closes
+        int64_t watermark;
+        if (checked_sub(timestamp, lateness_, watermark) && watermark > watermark_)
+        {
+            close(watermark);
+        }
+    }
+
+    void close(int64_t watermark)
+    {
+        watermark_ = watermark;
+
+        size_t closed = 0;
+        for (; closed < windows_.size() && windows_[closed].start + size_ <= watermark_; closed++)
+        {
+            if (callback_)
+            {
+                callback_(windows_[closed].start, windows_[closed].start + size_, windows_[closed].records, windows_[closed].values);
+            }
+        }
+
+        windows_.erase(windows_.begin(), windows_.begin() + closed);
+    }
+
+    std::string timestamp_path_;
+    std::string value_path_;
+    int64_t size_;
+    int64_t slide_;
+    int64_t lateness_;
+    CallBackType callback_;
+
+    // Current record
+    int64_t timestamp_ = 0;
+    bool has_timestamp_ = false;
+    double value_ = 0.0;
+    bool has_value_ = false;
+
+    // Open windows, sorted by start
+    std::vector<Window> windows_;
+    int64_t watermark_ = std::numeric_limits<int64_t>::min();
+    size_t late_ = 0;
+    size_t gaps_ = 0;
+};
+
+/**
+ * @struct HyperLogLog
+ *
+ * @brief Approximate number of distinct hashes in 2^PRECISION bytes, sketches of the same precision can be merged
+*/
+template<size_t PRECISION = 12>
+struct HyperLogLog
+{
+    static_assert(PRECISION >= 4 && PRECISION <= 18, "PRECISION must be in [4, 18]");
+
+    static constexpr size_t REGISTERS = size_t(1) << PRECISION;
+
+    void add(uint64_t hash)
+    {
+        size_t index = hash >> (64 - PRECISION);
+
+        // Guard bit bounds the rank when the remaining bits are all zero
+        uint64_t rest = (hash << PRECISION) | (uint64_t(1) << (PRECISION - 1));
+        uint8_t rank = static_cast<uint8_t>(std::countl_zero(rest) + 1);
+
+        registers_[index] = std::max(registers_[index], rank);
+    }
+
+    void merge(const HyperLogLog & other)
+    {
+        for (size_t i = 0; i < REGISTERS; i++)
+        {
+            registers_[i] = std::max(registers_[i], other.registers_[i]);
+        }
+    }
+
+    double estimate() const
+    {
+        double sum = 0.0;
+        size_t zeros = 0;
+
+        for (uint8_t rank : registers_)
+        {
+            sum += std::ldexp(1.0, -static_cast<int>(rank));
+            zeros += (rank == 0);
+        }
+
+        double m = static_cast<double>(REGISTERS);
+        double estimate = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+
+        // Linear counting is more accurate for small cardinalities
+        if (estimate <= 2.5 * m && zeros != 0)
+        {
+            estimate = m * std::log(m / static_cast<double>(zeros));
+        }
+
+        return estimate;
+    }
+
+    void clear()
+    {
+        registers_.fill(0);
+    }
+
+    std::array<uint8_t, REGISTERS> registers_ = {};
+};
+
+/**
+ * @struct CountMinSketch
+ *
+ * @brief Approximate frequency of hashes, never underestimates, sketches of the same size can be merged
+*/
+template<size_t WIDTH = 1024, size_t DEPTH = 4>
+struct CountMinSketch
+{
+    static_assert(std::has_single_bit(WIDTH), "WIDTH must be a power of two");
+
+    CountMinSketch()
+    : counters_(WIDTH * DEPTH, 0)
+    {
+    }
+
+    void add(uint64_t hash, uint64_t count = 1)
+    {
+        for (size_t row = 0; row < DEPTH; row++)
+        {
+            counters_[row * WIDTH + column(hash, row)] += count;
+        }
+    }
+
+    uint64_t estimate(uint64_t hash) const
+    {
+        uint64_t result = std::numeric_limits<uint64_t>::max();
+
+        for (size_t row = 0; row < DEPTH; row++)
+        {
+            result = std::min(result, counters_[row * WIDTH + column(hash, row)]);
+        }
+
+        return result;
+    }
+
+    void merge(const CountMinSketch & other)
+    {
+        for (size_t i = 0; i < counters_.size(); i++)
+        {
+            counters_[i] += other.counters_[i];
+        }
+    }
+
+    void clear()
+    {
+        std::fill(counters_.begin(), counters_.end(), 0);
+    }
+
+protected:
+
+    // Rows derived from the two halves of one hash
+    static size_t column(uint64_t hash, size_t row)
+    {
+        uint32_t low = static_cast<uint32_t>(hash);
+        uint32_t high = static_cast<uint32_t>(hash >> 32) | 1;
+        return (low + row * high) & (WIDTH - 1);
+    }
+
+    std::vector<uint64_t> counters_;
+};
+
+/**
+ * @class SpaceSaving
+ *
+ * @brief Keeps the K most frequent values of a stream, each count overestimates by at most its error
+*/
+template<size_t K = 16>
+class SpaceSaving
+{
+public:
+    struct Entry
+    {
+        std::string value;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    void add(const std::string_view & value, uint64_t hash, uint64_t count = 1)
+    {
+        // Hashes are kept apart so the scan touches one cache line per 8 entries
+        for (size_t i = 0; i < hashes_.size(); i++)
+        {
+            if (hashes_[i] == hash && entries_[i].value == value)
+            {
+                entries_[i].count += count;
+                return;
+            }
+        }
+
+        if (entries_.size() < K)
+        {
+            hashes_.push_back(hash);
+            entries_.push_back(Entry{std::string(value), count, 0});
+            return;
+        }
+
+        // Replace the least frequent value, which inherits its count as error
+        size_t min = 0;
+        for (size_t i = 1; i < entries_.size(); i++)
+        {
+            min = entries_[i].count < entries_[min].count ? i : min;
+        }
+
+        hashes_[min] = hash;
+        entries_[min].value.assign(value.data(), value.size());
+        entries_[min].error = entries_[min].count;
+        entries_[min].count += count;
+    }
+
+    void merge(const SpaceSaving & other)
+    {
+        for (size_t i = 0; i < other.entries_.size(); i++)
+        {
+            add(other.entries_[i].value, other.hashes_[i], other.entries_[i].count);
+        }
+    }
+
+    /**
+     * @brief Tracked values, most frequent first
+    */
+    std::vector<Entry> top() const
+    {
+        std::vector<Entry> result = entries_;
+        std::stable_sort(result.begin(), result.end(), [](const Entry & a, const Entry & b)
+        {
+            return a.count > b.count;
+        });
+        return result;
+    }
+
+    void clear()
+    {
+        hashes_.clear();
+        entries_.clear();
+    }
+
+protected:
+    std::vector<uint64_t> hashes_;
+    std::vector<Entry> entries_;
+};
+
+/**
+ * @class DistinctCountListener
+ *
+ * @brief A JSON listener that estimates the number of distinct values at the paths matching a filter
+ *
+ * The raw bytes of each value are hashed into a HyperLogLog, values are never materialized.
+ * Strings are distinct by their raw text, so "a" and its escaped form "\u0061" count twice.
+*/
+template<CTRE_REGEX_INPUT_TYPE filter, size_t PRECISION = 12>
+struct DistinctCountListener : public MatchListener<filter>
+{
+    double estimate() const
+    {
+        return sketch_.estimate();
+    }
+
+    void merge(const DistinctCountListener & other)
+    {
+        sketch_.merge(other.sketch_);
+    }
+
+    void reset()
+    {
+        sketch_.clear();
+    }
+
+protected:
+
+    void on_match(const std::string_view & /* path */, const std::string_view & raw) override
+    {
+        sketch_.add(detail::hash_bytes(raw.data(), raw.size()));
+    }
+
+    HyperLogLog<PRECISION> sketch_;
+};
+
+/**
+ * @class HeavyHittersListener
+ *
+ * @brief A JSON listener that tracks the most frequent values at the paths matching a filter
+ *
+ * The top K values are kept by a SpaceSaving summary and the frequency of any value can be
+ * estimated from a CountMinSketch. Both are fed by the hash of the raw bytes of each value.
+*/
+template<CTRE_REGEX_INPUT_TYPE filter, size_t K = 16, size_t WIDTH = 1024, size_t DEPTH = 4>
+struct HeavyHittersListener : public MatchListener<filter>
+{
+    using Entry = typename SpaceSaving<K>::Entry;
+
+    /**
+     * @brief Most frequent values (raw JSON text), most frequent first
+    */
+    std::vector<Entry> top() const
+    {
+        return top_.top();
+    }
+
+    /**
+     * @brief Upper bound of the number of times a value (raw JSON text) has been seen
+    */
+    uint64_t count(const std::string_view & raw) const
+    {
+        return frequencies_.estimate(detail::hash_bytes(raw.data(), raw.size()));
+    }
+
+    void merge(const HeavyHittersListener & other)
+    {
+        top_.merge(other.top_);
+        frequencies_.merge(other.frequencies_);
+    }
+
+    void reset()
+    {
+        top_.clear();
+        frequencies_.clear();
+    }
+
+protected:
+
+    void on_match(const std::string_view & /* path */, const std::string_view & raw) override
+    {
+        uint64_t hash = detail::hash_bytes(raw.data(), raw.size());
+        top_.add(raw, hash);
+        frequencies_.add(hash);
+    }
+
+    SpaceSaving<K> top_;
+    CountMinSketch<WIDTH, DEPTH> frequencies_;
+};
+
+/**
+ * @class MultiListener
+ *
+ * @brief A JSON listener that acts as a multiplexer
+*/
+class MultiListener : public IJSONListener
+{
+public:
+    MultiListener() = default;
+
+    MultiListener(std::initializer_list<IJSONListener *> listeners)
+    : listeners_(listeners)
+    {
+    }
+
+    void on_object_start() override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_object_start();
+        }
+    };
+    void on_object_end() override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_object_end();
+        }
+    };
+    void on_array_start() override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_array_start();
+        }
+    };
+    void on_array_end() override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_array_end();
+        }
+    };
+    void on_array_next_element() override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_array_next_element();
+        }
+    };
+    void on_key(const std::string_view& key) override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_key(key);
+        }
+    };
+    void on_value(const JSONValue& value) override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_value(value);
+        }
+    };
+    void on_document_end() override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_document_end();
+        }
+    };
+    void on_partial_value(const std::string_view& delta) override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_partial_value(delta);
+        }
+    };
+    void on_raw_value(const std::string_view& raw) override
+    {
+        for (auto listener : listeners_)
+        {
+            listener->on_raw_value(raw);
+        }
+    };
+
+    void add_listener(IJSONListener & listener)
+    {
+        listeners_.push_back(&listener);
+    }
+
+private:
+    std::vector<IJSONListener *> listeners_;
+};
+
+/**
+ * @class JSONWriter
+ *
+ * @brief A JSON listener that serializes the received events into a buffered output sink
+ *
+ * Parsed values and keys are written verbatim, strings are already escaped in the input. Values built by
+ * the caller through write_key() and write_string() are escaped. The output is compact and documents
+ * are separated by a newline. Call flush() once done.
+*/
+template<size_t BUFFER_SIZE>
+class JSONWriter : public IJSONListener
+{
+public:
+    using SinkType = std::function<void(const char *, size_t)>;
+
+    JSONWriter(SinkType sink)
+    : sink_(sink)
+    {
+    }
+
+    void on_object_start() override
+    {
+        separator();
+        put('{');
+        first_.push_back(true);
+    };
+
+    void on_object_end() override
+    {
+        first_.pop_back();
+        put('}');
+    };
+
+    void on_array_start() override
+    {
+        separator();
+        put('[');
+        first_.push_back(true);
+    };
+
+    void on_array_end() override
+    {
+        first_.pop_back();
+        put(']');
+    };
+
+    void on_key(const std::string_view & key) override
+    {
+        separator();
+        put('"');
+        write(key.data(), key.size());
+        write("\":", 2);
+        after_key_ = true;
+    };
+
+    void on_raw_value(const std::string_view & raw) override
+    {
+        // Copied as found in the input, so numbers keep their exact text (1e5, 1.0, integers beyond int64)
+        separator();
+        write(raw.data(), raw.size());
+    };
+
+    void on_value(const JSONValue & value) override
+    {
+        separator();
+
+        switch (value.type)
+        {
+            case JSONValue::Type::STRING:
+                put('"');
+                write(value.string.data(), value.string.size());
+                put('"');
+                break;
+            case JSONValue::Type::FLOATING:
+                write_number(value.floating);
+                break;
+            case JSONValue::Type::INTEGER:
+                write_number(value.integer);
+                break;
+            case JSONValue::Type::BOOLEAN:
+                if (value.boolean)
+                {
+                    write("true", 4);
+                }
+                else
+                {
+                    write("false", 5);
+                }
+                break;
+            default:
+                write("null", 4);
+                break;
+        }
+    };
+
+    void on_document_end() override
+    {
+        put('\n');
+    };
+
+    void write_key(const std::string_view & key)
+    {
+        separator();
+        write_escaped(key);
+        put(':');
+        after_key_ = true;
+    }
+
+    void write_string(const std::string_view & value)
+    {
+        separator();
+        write_escaped(value);
+    }
+
+    void write_integer(int64_t value)
+    {
+        separator();
+        write_number(value);
+    }
+
+    void write_floating(double value)
+    {
+        separator();
+        write_number(value);
+    }
+
+    void write_boolean(bool value)
+    {
+        separator();
+        if (value)
+        {
+            write("true", 4);
+        }
+        else
+        {
+            write("false", 5);
+        }
+    }
+
+    void write_null()
+    {
+        separator();
+        write("null", 4);
+    }
+
+    /**
+     * @brief Write already serialized JSON bytes as the next value, append_raw() continues it
+    */
+    void write_raw(const char * data, size_t size)
+    {
+        separator();
+        write(data, size);
+    }
+
+    void append_raw(const char * data, size_t size)
+    {
+        write(data, size);
+    }
+
+    void flush()
+    {
+        if (used_ > 0)
+        {
+            sink_(buffer_.data(), used_);
+            used_ = 0;
+        }
+    }
+
+protected:
+
+    void separator()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+        }
+        else if (!first_.empty())
+        {
+            if (first_.back())
+            {
+                first_.back() = false;
+            }
+            else
+            {
+                put(',');
+            }
+        }
+    }
+
+    void put(const char c)
+    {
+        if (used_ == BUFFER_SIZE)
+        {
+            flush();
+        }
+        buffer_[used_++] = c;
+    }
+
+    void write(const char * data, size_t size)
+    {
+        if (size > BUFFER_SIZE - used_)
+        {
+            flush();
+
+            // Too big to be buffered
+            if (size >= BUFFER_SIZE)
+            {
+                sink_(data, size);
+                return;
+            }
+        }
+
+        memcpy(buffer_.data() + used_, data, size);
+        used_ += size;
+    }
+
+    template<typename NumberType>
+    void write_number(NumberType value)
+    {
+        if constexpr (std::is_floating_point_v<NumberType>)
+        {
+            // No representation for NaN and infinity
+            if (!std::isfinite(value))
+            {
+                write("null", 4);
+                return;
+            }
+        }
+
+        std::array<char, 32> number;
+        auto result = std::to_chars(number.data(), number.data() + number.size(), value);
+        write(number.data(), result.ptr - number.data());
+    }
+
+    static bool needs_escape(const char c)
+    {
+        return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+    }
+
+    void write_escaped(const std::string_view & value)
+    {
+        static constexpr char HEX[] = "0123456789abcdef";
+
+        put('"');
+
+        const char * data = value.data();
+        const size_t size = value.size();
+        size_t clean_start = 0;
+        size_t i = 0;
+
+        while (i < size)
+        {
+            // Skip 8 bytes at once while none of them needs escaping
+            if (i + 8 <= size)
+            {
+                uint64_t word = detail::load64(data + i);
+                if (!(detail::has_byte(word, '"') | detail::has_byte(word, '\\') | detail::has_less_than(word, 0x20)))
+                {
+                    i += 8;
+                    continue;
+                }
+            }
+
+            size_t end = std::min(i + 8, size);
+            for (; i < end; i++)
+            {
+                const char c = data[i];
+
+                if (!needs_escape(c))
+                {
+                    continue;
+                }
+
+                write(data + clean_start, i - clean_start);
+                clean_start = i + 1;
+
+                switch (c)
+                {
+                    case '"': write("\\\"", 2); break;
+                    case '\\': write("\\\\", 2); break;
+                    case '\b': write("\\b", 2); break;
+                    case '\f': write("\\f", 2); break;
+                    case '\n': write("\\n", 2); break;
+                    case '\r': write("\\r", 2); break;
+                    case '\t': write("\\t", 2); break;
+                    default:
+                    {
+                        const char unicode[] = {'\\', 'u', '0', '0', HEX[(c >> 4) & 0xF], HEX[c & 0xF]};
+                        write(unicode, sizeof(unicode));
+                        break;
+                    }
+                }
+            }
+        }
+
+        write(data + clean_start, size - clean_start);
+        put('"');
+    }
+
+    SinkType sink_;
+    std::array<char, BUFFER_SIZE> buffer_;
+    size_t used_ = 0;
+
+    // State variables
+    std::vector<bool> first_;
+    bool after_key_ = false;
+};
+
+/**
+ * @class CanonicalHashListener
+ *
+ * @brief A JSON listener that computes a canonical 64 bit digest of each document
+ *
+ * The digest does not depend on whitespace, string escaping, number formatting (1, 1.0 and 1e0 are equal)
+ * or the order of object members: members are hashed with their key and combined with a commutative sum.
+ * Array order is significant. Memory usage only depends on the nesting depth.
+*/
+class CanonicalHashListener : public IJSONListener
+{
+public:
+    using CallBackType = std::function<void(uint64_t)>;
+
+    CanonicalHashListener() = default;
+
+    CanonicalHashListener(CallBackType callback)
+    : callback_(callback)
+    {
+    }
+
+    void on_object_start() override
+    {
+        frames_.push_back(Frame{true, 0, 0, 0});
+    };
+
+    void on_object_end() override
+    {
+        close_frame(OBJECT_SEED);
+    };
+
+    void on_array_start() override
+    {
+        frames_.push_back(Frame{false, 0, 0, 0});
+    };
+
+    void on_array_end() override
+    {
+        close_frame(ARRAY_SEED);
+    };
+
+    void on_key(const std::string_view & key) override
+    {
+        if (!frames_.empty())
+        {
+            frames_.back().key_hash = hash_string(key, KEY_SEED);
+        }
+    };
+
+    void on_raw_value(const std::string_view & raw) override
+    {
+        // Numbers are hashed from their text, the JSONValue classification ignores exponents.
+        // Integers out of the int64_t range are hashed as doubles, like their exponent forms.
+        int64_t integer;
+        double number;
+
+        if (raw.front() == '"')
+        {
+            add(hash_string(raw.substr(1, raw.size() - 2), STRING_SEED));
+        }
+        else if (detail::parse_integer(raw, integer))
+        {
+            add(hash_integer(integer));
+        }
+        else if (detail::parse_number(raw, number))
+        {
+            add(hash_floating(number));
+        }
+        else
+        {
+            on_value(JSONValue(raw));
+        }
+    };
+
+    void on_value(const JSONValue & value) override
+    {
+        add(hash_value(value));
+    };
+
+    void on_document_end() override
+    {
+        frames_.clear();
+
+        if (callback_)
+        {
+            callback_(digest_);
+        }
+    };
+
+    /**
+     * @brief Digest of the last completed document
+    */
+    uint64_t digest() const
+    {
+        return digest_;
+    }
+
+protected:
+
+    struct Frame
+    {
+        bool is_object;
+        uint64_t accumulator;
+        size_t count;
+        uint64_t key_hash;
+    };
+
+    static constexpr uint64_t OBJECT_SEED = 0x6f626a656374ULL;
+    static constexpr uint64_t ARRAY_SEED = 0x6172726179ULL;
+    static constexpr uint64_t KEY_SEED = 0x6b6579ULL;
+    static constexpr uint64_t STRING_SEED = 0x737472ULL;
+    static constexpr uint64_t NUMBER_SEED = 0x6e756dULL;
+    static constexpr uint64_t INTEGER_SEED = 0x696e74ULL;
+
+    void add(uint64_t hash)
+    {
+        if (frames_.empty())
+        {
+            digest_ = hash;
+            return;
+        }
+
+        Frame & frame = frames_.back();
+        frame.count++;
+
+        if (frame.is_object)
+        {
+            // Commutative, member order does not matter
+            frame.accumulator += detail::mix64(frame.key_hash ^ std::rotl(hash, 23));
+        }
+        else
+        {
+            frame.accumulator = detail::mix64(frame.accumulator ^ hash) * 0x9e3779b97f4a7c15ULL;
+        }
+    }
+
+    void close_frame(uint64_t seed)
+    {
+        if (frames_.empty())
+        {
+            return;
+        }
+
+        Frame frame = frames_.back();
+        frames_.pop_back();
+
+        add(detail::mix64(seed ^ detail::mix64(frame.accumulator + frame.count)));
+    }
+
+    uint64_t hash_string(const std::string_view & raw, uint64_t seed)
+    {
+        // Strings are compared by content, not by escaping
+        if (memchr(raw.data(), '\\', raw.size()) == nullptr)
+        {
+            return detail::hash_bytes(raw.data(), raw.size(), seed);
+        }
+
+        detail::unescape(raw, unescaped_);
+        return detail::hash_bytes(unescaped_.data(), unescaped_.size(), seed);
+    }
+
+    static uint64_t hash_integer(int64_t integer)
+    {
+        return detail::mix64(INTEGER_SEED ^ static_cast<uint64_t>(integer));
+    }
+
+    static uint64_t hash_floating(double number)
+    {
+        // Integral values hash as integers, -0.0 as 0.0
+        if (std::trunc(number) == number && std::abs(number) < 9.2e18)
+        {
+            return hash_integer(static_cast<int64_t>(number));
+        }
+        return detail::mix64(NUMBER_SEED ^ std::bit_cast<uint64_t>(number));
+    }
+
+    uint64_t hash_value(const JSONValue & value)
+    {
+        switch (value.type)
+        {
+            case JSONValue::Type::STRING:
+                return hash_string(value.string, STRING_SEED);
+            case JSONValue::Type::INTEGER:
+                return hash_integer(value.integer);
+            case JSONValue::Type::FLOATING:
+                return hash_floating(value.floating);
+            case JSONValue::Type::BOOLEAN:
+                return detail::mix64(value.boolean ? 1 : 2);
+            case JSONValue::Type::NULL_VALUE:
+                return detail::mix64(3);
+            default:
+                return detail::mix64(4);
+        }
+    }
+
+    CallBackType callback_;
+    std::vector<Frame> frames_;
+    std::string unescaped_;
+    uint64_t digest_ = 0;
+};
+
+/**
+ * @struct TapeNode
+ *
+ * @brief A node of a Tape, offsets and sizes point into the arena of the tape
+*/
+struct TapeNode
+{
+    StaticNode::Kind kind;
+
+    // Key of object members without quotes, still escaped like IJSONListener::on_key()
+    uint32_t key_offset;
+    uint32_t key_size;
+
+    // Raw bytes of values (strings include their quotes), empty for containers
+    uint32_t raw_offset;
+    uint32_t raw_size;
+
+    // Index of the next sibling, one past the last descendant
+    uint32_t end;
+};
+
+/**
+ * @class Tape
+ *
+ * @brief A document stored as a flat array of nodes in document order, see TapeBuilder
+ *
+ * Like StaticJSON, children follow their container and end() jumps over a whole subtree, so siblings are
+ * skipped in O(1). Keys and raw values live in a single arena and scalars are only decoded by value().
+ * Offsets are 32 bit, a tape holds up to 4 GiB of keys and values, see TapeBuilder::failed().
+*/
+class Tape
+{
+public:
+    std::vector<TapeNode> nodes;
+    std::string arena;
+
+    size_t size() const
+    {
+        return nodes.size();
+    }
+
+    bool empty() const
+    {
+        return nodes.empty();
+    }
+
+    void clear()
+    {
+        nodes.clear();
+        arena.clear();
+    }
+
+    StaticNode::Kind kind(size_t index) const
+    {
+        return nodes[index].kind;
+    }
+
+    size_t end(size_t index) const
+    {
+        return nodes[index].end;
+    }
+
+    std::string_view key(size_t index) const
+    {
+        return std::string_view(arena.data() + nodes[index].key_offset, nodes[index].key_size);
+    }
+
+    std::string_view raw(size_t index) const
+    {
+        return std::string_view(arena.data() + nodes[index].raw_offset, nodes[index].raw_size);
+    }
+
+    /**
+     * @brief Decoded value of a VALUE node
+    */
+    JSONValue value(size_t index) const
+    {
+        return JSONValue(raw(index));
+    }
+
+    /**
+     * @brief Index of the node at a path in the format of FilterListener queries (e.g. "owners[1].name")
+     *
+     * @param path The path, relative to the node at index
+     * @param index The node where the lookup starts, the root by default
+     * @return The index, std::string_view::npos if missing
+    */
+    size_t find(std::string_view path, size_t index = 0) const
+    {
+        return index < size() ? detail::find_path(*this, path, index) : std::string_view::npos;
+    }
+};
+
+/**
+ * @class TapeBuilder
+ *
+ * @brief A listener that records each document into a Tape for random access once streamed
+ *
+ * The callback receives the tape of every completed document, which is reused by the next one: the
+ * nodes and the arena keep their capacity, so steady state parsing does not allocate. Typed floating
+ * values keep a fractional part or an exponent, so value() reads them back as floating. A document
+ * that does not fit the 32 bit offsets of the tape is dropped and reported by failed().
+*/
+class TapeBuilder : public IJSONListener
+{
+public:
+    using CallBackType = std::function<void(const Tape &)>;
+
+    TapeBuilder() = default;
+
+    TapeBuilder(CallBackType callback)
+    : callback_(callback)
+    {
+    }
+
+    void on_object_start() override
+    {
+        open(StaticNode::Kind::OBJECT);
+    };
+
+    void on_object_end() override
+    {
+        close();
+    };
+
+    void on_array_start() override
+    {
+        open(StaticNode::Kind::ARRAY);
+    };
+
+    void on_array_end() override
+    {
+        close();
+    };
+
+    void on_key(const std::string_view & key) override
+    {
+        if (!begin(key.size()))
+        {
+            return;
+        }
+
+        key_offset_ = static_cast<uint32_t>(tape_.arena.size());
+        key_size_ = static_cast<uint32_t>(key.size());
+        tape_.arena.append(key);
+    };
+
+    void on_raw_value(const std::string_view & raw) override
+    {
+        if (!begin(raw.size()))
+        {
+            return;
+        }
+
+        uint32_t offset = static_cast<uint32_t>(tape_.arena.size());
+        tape_.arena.append(raw);
+        push(StaticNode::Kind::VALUE, offset, static_cast<uint32_t>(raw.size()));
+    };
+
+    void on_value(const JSONValue & value) override
+    {
+        // Typed values (binary decoders) are stored as JSON text
+        std::string & text = text_;
+
+        if (value.type == JSONValue::Type::STRING)
+        {
+            text.assign(1, '"');
+            text += value.string;
+            text += '"';
+        }
+        else if (value.type == JSONValue::Type::FLOATING)
+        {
+            char number[32];
+            auto result = std::to_chars(number, number + sizeof(number), value.floating);
+            text.assign(number, result.ptr - number);
+
+            // 1.0 is written as "1", which would read back as an integer
+            if (text.find_first_of(".en") == std::string::npos)
+            {
+                text += ".0";
+            }
+        }
+        else
+        {
+            text = value.to_string();
+        }
+
+        TapeBuilder::on_raw_value(text);
+    };
+
+    void on_document_end() override
+    {
+        complete_ = true;
+        stack_.clear();
+
+        if (failed_)
+        {
+            tape_.clear();
+        }
+        else if (callback_)
+        {
+            callback_(tape_);
+        }
+    };
+
+    /**
+     * @brief Whether the last document overflowed the 32 bit offsets of the tape and was dropped
+    */
+    bool failed() const
+    {
+        return failed_;
+    }
+
+    /**
+     * @brief Tape of the last completed document, or of the one being built
+    */
+    const Tape & tape() const
+    {
+        return tape_;
+    }
+
+protected:
+
+    // Starts a new tape after a completed document, false once the next node and its size bytes overflow
+    bool begin(size_t size = 0)
+    {
+        if (complete_)
+        {
+            tape_.clear();
+            complete_ = false;
+            failed_ = false;
+        }
+
+        constexpr size_t LIMIT = std::numeric_limits<uint32_t>::max();
+        if (tape_.arena.size() + size > LIMIT || tape_.nodes.size() >= LIMIT)
+        {
+            failed_ = true;
+        }
+
+        return !failed_;
+    }
+
+    void push(StaticNode::Kind kind, uint32_t raw_offset, uint32_t raw_size)
+    {
+        tape_.nodes.push_back(TapeNode{kind, key_offset_, key_size_, raw_offset, raw_size,
+            static_cast<uint32_t>(tape_.nodes.size() + 1)});
+        key_offset_ = 0;
+        key_size_ = 0;
+    }
+
+    void open(StaticNode::Kind kind)
+    {
+        if (!begin())
+        {
+            return;
+        }
+
+        stack_.push_back(static_cast<uint32_t>(tape_.nodes.size()));
+        push(kind, 0, 0);
+    }
+
+    void close()
+    {
+        if (!failed_ && !stack_.empty())
+        {
+            tape_.nodes[stack_.back()].end = static_cast<uint32_t>(tape_.nodes.size());
+            stack_.pop_back();
+        }
+    }
+
+    CallBackType callback_;
+    Tape tape_;
+    std::string text_;
+
+    // State variables
+    std::vector<uint32_t> stack_;
+    uint32_t key_offset_ = 0;
+    uint32_t key_size_ = 0;
+    bool complete_ = false;
+    bool failed_ = false;
+};
+
+/**
+ * @class SubtreeListener
+ *
+ * @brief A JSON listener that records the objects and arrays at the paths matching a filter into a Tape
+ *
+ * The callback receives the tape of each matched subtree once it is closed, so predicates over sibling
+ * fields that arrive in any order (e.g. "owners whose age is over 26") need no DOM of the whole document.
+ * Subtrees larger than MAX_SIZE bytes (keys, raw values and nodes) stop being recorded and are only
+ * counted by truncated(). Matches nested in a recorded subtree are part of it.
+*/
+template<CTRE_REGEX_INPUT_TYPE filter, size_t MAX_SIZE = 4096>
+struct SubtreeListener : public JSONListener
+{
+    using CallBackType = std::function<void(const std::string_view &, const Tape &, const std::vector<size_t>&)>;
+
+    SubtreeListener(CallBackType callback)
+    : callback_(callback)
+    {
+    }
+
+    void on_object_start() override
+    {
+        if (enter() && reserve(sizeof(TapeNode)))
+        {
+            builder_.on_object_start();
+        }
+        JSONListener::on_object_start();
+    };
+
+    void on_object_end() override
+    {
+        if (recording())
+        {
+            builder_.on_object_end();
+        }
+        JSONListener::on_object_end();
+        leave();
+    };
+
+    void on_array_start() override
+    {
+        if (enter() && reserve(sizeof(TapeNode)))
+        {
+            builder_.on_array_start();
+        }
+        JSONListener::on_array_start();
+    };
+
+    void on_array_end() override
+    {
+        if (recording())
+        {
+            builder_.on_array_end();
+        }
+        JSONListener::on_array_end();
+        leave();
+    };
+
+    void on_key(const std::string_view & key) override
+    {
+        if (recording() && reserve(key.size()))
+        {
+            builder_.on_key(key);
+        }
+        JSONListener::on_key(key);
+    };
+
+    void on_value(const JSONValue & value) override
+    {
+        // Typed values other than strings take at most 32 bytes of text
+        size_t size = value.type == JSONValue::Type::STRING ? value.string.size() + 2 : 32;
+        if (recording() && reserve(size + sizeof(TapeNode)))
+        {
+            builder_.on_value(value);
+        }
+        JSONListener::on_value(value);
+    };
+
+    void on_raw_value(const std::string_view & raw) override
+    {
+        if (recording() && reserve(raw.size() + sizeof(TapeNode)))
+        {
+            builder_.on_raw_value(raw);
+        }
+
+        // Got a key and a value
+        key_.clear();
+    };
+
+    void on_document_end() override
+    {
+        depth_ = 0;
+        JSONListener::on_document_end();
+    };
+
+    /**
+     * @brief Number of matched subtrees dropped for exceeding MAX_SIZE
+    */
+    size_t truncated() const
+    {
+        return truncated_count_;
+    }
+
+protected:
+
+    bool recording() const
+    {
+        return depth_ > 0 && !truncated_;
+    }
+
+    // Starts recording on a match, or goes one level deeper in the recorded subtree
+    bool enter()
+    {
+        if (depth_ == 0)
+        {
+            match_ = path();
+            if (!ctre::match<filter>(std::string_view(match_)))
+            {
+                return false;
+            }
+            truncated_ = false;
+            size_ = 0;
+        }
+
+        depth_++;
+        return !truncated_;
+    }
+
+    void leave()
+    {
+        if (depth_ == 0 || --depth_ > 0)
+        {
+            return;
+        }
+
+        // Closes the tape, it is cleared by the next match
+        builder_.on_document_end();
+
+        if (truncated_)
+        {
+            truncated_count_++;
+        }
+        else
+        {
+            callback_(match_, builder_.tape(), array_depth_);
+        }
+    }
+
+    // Counts the bytes an event adds to the tape before it is recorded, false once over MAX_SIZE
+    bool reserve(size_t size)
+    {
+        size_ += size;
+        truncated_ = size_ > MAX_SIZE;
+        return !truncated_;
+    }
+
+    CallBackType callback_;
+    TapeBuilder builder_;
+
+    // State variables
+    std::string match_;
+    size_t depth_ = 0;
+    size_t size_ = 0;
+    bool truncated_ = false;
+    size_t truncated_count_ = 0;
+};
+
+/**
+ * @class PredicateListener
+ *
+ * @brief A JSON listener for JSONPath-like filters over the objects of an array,
+ *        e.g. "jobs[?(@.status=="completed" && @.attempt>1)].conclusion"
+ *
+ * Conditions compare a field of the element with a string, number, true, false or null literal using
+ * ==, !=, <, <=, > or >=, and are joined with &&. Each condition is decided as soon as its field arrives
+ * and the selected value is only buffered while some condition is still pending, so memory is bounded
+ * by the relevant fields of the current element. A missing field fails its condition. Only scalars
+ * are selected: an object or array at the selected path is not reported, select its scalars instead
+ * (e.g. "...].steps[0]").
+*/
+class PredicateListener : public PathValueListener
+{
+public:
+    using CallBackType = std::function<void(const std::string_view &, const JSONValue &, const std::vector<size_t>&)>;
+
+    PredicateListener(const std::string_view & expression, CallBackType callback)
+    : callback_(callback)
+    {
+        valid_ = parse(expression);
+    }
+
+    void on_object_start() override
+    {
+        if (depth_ > 0)
+        {
+            depth_++;
+        }
+        else if (valid_ && is_element(path()))
+        {
+            depth_ = 1;
+            element_ = path();
+            std::fill(outcomes_.begin(), outcomes_.end(), Outcome::PENDING);
+            pending_ = conditions_.size();
+            has_selected_ = false;
+        }
+
+        JSONListener::on_object_start();
+    };
+
+    void on_object_end() override
+    {
+        if (depth_ > 0 && --depth_ == 0)
+        {
+            // Conditions still pending have no field, a buffered value is dropped
+            selected_.clear();
+            has_selected_ = false;
+        }
+
+        JSONListener::on_object_end();
+    };
+
+    void on_document_end() override
+    {
+        depth_ = 0;
+        JSONListener::on_document_end();
+    };
+
+    /**
+     * @brief False if the expression could not be parsed, nothing is matched then
+    */
+    bool valid() const
+    {
+        return valid_;
+    }
+
+protected:
+
+    enum class Operator : uint8_t
+    {
+        EQUAL,
+        NOT_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL
+    };
+
+    enum class Outcome : uint8_t
+    {
+        PENDING,
+        PASSED,
+        FAILED
+    };
+
+    struct Condition
+    {
+        std::string field;
+        Operator op;
+
+        // Raw JSON text of the literal, strings keep their quotes
+        std::string literal;
+        double number;
+        bool is_number;
+    };
+
+    static std::string_view trim(std::string_view text)
+    {
+        size_t start = text.find_first_not_of(" \t\r\n");
+        if (start == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        return text.substr(start, text.find_last_not_of(" \t\r\n") - start + 1);
+    }
+
+    bool parse(std::string_view expression)
+    {
+        expression = trim(expression);
+        if (expression.substr(0, 2) == "$.")
+        {
+            expression.remove_prefix(2);
+        }
+        else if (expression.substr(0, 1) == "$")
+        {
+            expression.remove_prefix(1);
+        }
+
+        size_t open = expression.find("[?(");
+        size_t close = expression.rfind(")]");
+        if (open == std::string_view::npos || close == std::string_view::npos || close < open ||
+            expression.substr(close + 2, 1) != ".")
+        {
+            return false;
+        }
+
+        // Elements of a root array have the "_" path
+        array_ = open ? std::string(expression.substr(0, open)) : "_";
+        selected_path_ = std::string(expression.substr(close + 3));
+
+        std::string_view conditions = expression.substr(open + 3, close - open - 3);
+        while (!conditions.empty())
+        {
+            size_t split = find_and(conditions);
+            if (!parse_condition(trim(conditions.substr(0, split))))
+            {
+                return false;
+            }
+            conditions.remove_prefix(split == std::string_view::npos ? conditions.size() : split + 2);
+        }
+
+        outcomes_.resize(conditions_.size());
+        return !conditions_.empty() && !selected_path_.empty();
+    }
+
+    // Position of the first "&&" outside of string literals
+    static size_t find_and(const std::string_view & text)
+    {
+        bool in_string = false;
+        for (size_t i = 0; i + 1 < text.size(); i++)
+        {
+            if (in_string)
+            {
+                // Skips escaped characters, escaped quotes included
+                if (text[i] == '\\')
+                {
+                    i++;
+                }
+                else
+                {
+                    in_string = text[i] != '"';
+                }
+            }
+            else if (text[i] == '"')
+            {
+                in_string = true;
+            }
+            else if (text[i] == '&' && text[i + 1] == '&')
+            {
+                return i;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    bool parse_condition(std::string_view text)
+    {
+        if (text.substr(0, 2) != "@.")
+        {
+            return false;
+        }
+
+        size_t op_start = text.find_first_of("=!<> ");
+        if (op_start == std::string_view::npos)
+        {
+            return false;
+        }
+
+        Condition condition;
+        condition.field = std::string(text.substr(2, op_start - 2));
+        text = trim(text.substr(op_start));
+
+        static constexpr std::pair<std::string_view, Operator> OPERATORS[] = {
+            {"==", Operator::EQUAL}, {"!=", Operator::NOT_EQUAL}, {"<=", Operator::LESS_EQUAL},
+            {">=", Operator::GREATER_EQUAL}, {"<", Operator::LESS}, {">", Operator::GREATER}
+        };
+
+        bool found = false;
+        for (const auto & [symbol, op] : OPERATORS)
+        {
+            if (text.substr(0, symbol.size()) == symbol)
+            {
+                condition.op = op;
+                text.remove_prefix(symbol.size());
+                found = true;
+                break;
+            }
+        }
+
+        text = trim(text);
+        if (!found || condition.field.empty() || text.empty())
+        {
+            return false;
+        }
+
+        condition.literal = std::string(text);
+        condition.is_number = detail::parse_number(text, condition.number);
+
+        bool is_string = text.size() >= 2 && text.front() == '"' && text.back() == '"';
+        if (!condition.is_number && !is_string && text != "true" && text != "false" && text != "null")
+        {
+            return false;
+        }
+
+        conditions_.push_back(std::move(condition));
+        return true;
+    }
+
+    // Objects directly in the array, e.g. "jobs[3]" for "jobs"
+    bool is_element(const std::string_view & current) const
+    {
+        if (current.size() < array_.size() + 3 || current.substr(0, array_.size()) != array_ ||
+            current[array_.size()] != '[' || current.back() != ']')
+        {
+            return false;
+        }
+
+        for (size_t i = array_.size() + 1; i + 1 < current.size(); i++)
+        {
+            if (current[i] < '0' || current[i] > '9')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool compare(const Condition & condition, const std::string_view & raw)
+    {
+        int order;
+        double number;
+
+        if (condition.is_number)
+        {
+            if (!detail::parse_number(raw, number))
+            {
+                return condition.op == Operator::NOT_EQUAL;
+            }
+            order = (number > condition.number) - (number < condition.number);
+        }
+        else if (raw.front() == '"' && condition.literal.front() == '"')
+        {
+            // Escaped content, like JSONValue::string
+            order = raw.compare(condition.literal);
+            order = (order > 0) - (order < 0);
+        }
+        else
+        {
+            // true, false and null only compare for equality
+            bool equal = raw == condition.literal;
+            return condition.op == Operator::EQUAL ? equal : (condition.op == Operator::NOT_EQUAL && !equal);
+        }
+
+        switch (condition.op)
+        {
+            case Operator::EQUAL:
+                return order == 0;
+            case Operator::NOT_EQUAL:
+                return order != 0;
+            case Operator::LESS:
+                return order < 0;
+            case Operator::LESS_EQUAL:
+                return order <= 0;
+            case Operator::GREATER:
+                return order > 0;
+            default:
+                return order >= 0;
+        }
+    }
+
+    void on_path_value(const std::string_view & path, const std::string_view & raw) override
+    {
+        // Decided elements ignore the rest of their fields
+        if (depth_ == 0 || pending_ == std::numeric_limits<size_t>::max() || raw.empty())
+        {
+            return;
+        }
+
+        if (path.size() <= element_.size() + 1 || path.compare(0, element_.size(), element_) != 0 ||
+            path[element_.size()] != '.')
+        {
+            return;
+        }
+        std::string_view field = path.substr(element_.size() + 1);
+
+        for (size_t c = 0; c < conditions_.size(); c++)
+        {
+            if (outcomes_[c] != Outcome::PENDING || field != conditions_[c].field)
+            {
+                continue;
+            }
+
+            if (!compare(conditions_[c], raw))
+            {
+                outcomes_[c] = Outcome::FAILED;
+                pending_ = std::numeric_limits<size_t>::max();
+                selected_.clear();
+                return;
+            }
+
+            outcomes_[c] = Outcome::PASSED;
+            pending_--;
+
+            // The selected value was waiting for this condition
+            if (pending_ == 0 && has_selected_)
+            {
+                emit(selected_);
+                has_selected_ = false;
+                selected_.clear();
+            }
+        }
+
+        if (field == selected_path_)
+        {
+            if (pending_ == 0)
+            {
+                emit(raw);
+            }
+            else
+            {
+                selected_.assign(raw.data(), raw.size());
+                has_selected_ = true;
+            }
+        }
+    }
+
+    void emit(const std::string_view & raw)
+    {
+        std::string query = element_ + "." + selected_path_;
+        callback_(query, JSONValue(raw), array_depth_);
+    }
+
+    CallBackType callback_;
+    bool valid_ = false;
+
+    std::string array_;
+    std::string selected_path_;
+    std::vector<Condition> conditions_;
+
+    // State variables
+    std::vector<Outcome> outcomes_;
+    std::string element_;
+    std::string selected_;
+    size_t depth_ = 0;
+    size_t pending_ = 0;
+    bool has_selected_ = false;
+};
+
+/**
+ * @class StreamJson
+ *
+ * @brief A JSON parser that can be fed with chunks of data
+*/
+class StreamJson {
+public:
+    StreamJson()
+    : listener_(&dummy_listener_)
+    {
+    }
+
+    StreamJson(IJSONListener & listener)
+    : listener_(&listener)
+    {
+    }
+
+    size_t feed(const char * chunk, size_t size, size_t offset = 0)
+    {
+        if (offset != 0)
+        {
+            value_start_ = chunk;
+            value_size_ = offset;
+        }
+        else if(after_colon_ || value_start_ != nullptr)
+        {
+            // Pending value starts right at this chunk
+            value_start_ = chunk;
+            value_size_ = 0;
+        }
+
+        for (size_t i = offset; i < size; i++)
+        {
+            if (comment_ != Comment::NONE && comment_ != Comment::SLASH)
+            {
+                i = skip_comment(chunk, i, size);
+                continue;
+            }
+
+            const char & c = *(chunk + i);
+
+            Token token = get_token(c);
+
+            value_size_++;
+
+            // If we are processing a string, the only valid token is a quote that is not escaped
+            if (!state_stack_.empty() && state_stack_.back() == State::IN_STRING)
+            {
+                if (escaped_)
+                {
+                    escaped_ = false;
+                    continue;
+                }
+                else if (c == '\\')
+                {
+                    escaped_ = true;
+                    continue;
+                }
+                else if (token != Token::QUOTE)
+                {
+                    continue;
+                }
+            }
+            else if (lenient_ && lenient_char(c))
+            {
+                continue;
+            }
+
+            switch (token)
+            {
+                case Token::QUOTE:
+                    // If we are in a string, we are going to end it
+                    if (!state_stack_.empty() && state_stack_.back() == State::IN_STRING)
+                    {
+                        state_stack_.pop_back();
+
+                        // A value already reported in part gets its last delta, so deltas add up to the value
+                        if (partial_size_ > 0 && value_size_ - 2 > partial_size_)
+                        {
+                            listener_->on_partial_value(std::string_view(value_start_ + 1 + partial_size_, value_size_ - 2 - partial_size_));
+                        }
+
+                        // If this string is after a colon, it is a value
+                        if (after_colon_)
+                        {
+                            after_colon_ = false;
+                            emit_value(value_start_, value_size_);
+                        }
+                        else if (!state_stack_.empty() && state_stack_.back() == State::IN_ARRAY)
+                        {
+                            // Inside an array it is a value unless a colon follows, keep it until the next token
+                            array_string_size_ = value_size_;
+                            break;
+                        }
+                        else
+                        {
+                            listener_->on_key(std::string_view(value_start_ + 1, value_size_ - 2));
+                        }
+
+                        value_start_ = nullptr;
+                        value_size_ = 0;
+                    }
+                    else
+                    {
+                        value_start_ = &c;
+                        value_size_ = 1;
+                        partial_size_ = 0;
+                        state_stack_.push_back(State::IN_STRING);
+                    }
+                    break;
+                case Token::OBJECT_START:
+                    after_colon_ = false;
+                    value_start_ = nullptr;
+                    value_size_ = 0;
+                    listener_->on_object_start();
+                    state_stack_.push_back(State::IN_OBJECT);
+                    break;
+                case Token::OBJECT_END:
+                    if( after_colon_)
+                    {
+                        emit_value(value_start_, value_size_ - 1);
+                    }
+                    after_colon_ = false;
+                    if(!state_stack_.empty() && state_stack_.back() == State::IN_OBJECT)
+                    {
+                        listener_->on_object_end();
+                        state_stack_.pop_back();
+                        check_document_end();
+                    }
+                    value_start_ = nullptr;
+                    value_size_ = 0;
+                    break;
+                case Token::ARRAY_START:
+                    after_colon_ = false;
+                    value_start_ = &c + 1;
+                    value_size_ = 0;
+                    listener_->on_array_start();
+                    state_stack_.push_back(State::IN_ARRAY);
+                    break;
+                case Token::ARRAY_END:
+                    after_colon_ = false;
+
+                    if(value_start_ != nullptr)
+                    {
+                        // Empty arrays have no value
+                        emit_value(value_start_, value_size_ - 1);
+                        value_start_ = nullptr;
+                        value_size_ = 0;
+                        array_string_size_ = 0;
+                    }
+
+                    if(!state_stack_.empty() && state_stack_.back() == State::IN_ARRAY)
+                    {
+                        listener_->on_array_end();
+                        state_stack_.pop_back();
+                        check_document_end();
+                    }
+                    break;
+                case Token::COLON:
+                    if (array_string_size_ > 0)
+                    {
+                        listener_->on_key(std::string_view(value_start_ + 1, array_string_size_ - 2));
+                        array_string_size_ = 0;
+                    }
+                    after_colon_ = true;
+                    value_start_ = &c + 1;
+                    value_size_ = 0;
+                    break;
+                case Token::COMMA:
+                    // Maybe we found a value
+                    if( after_colon_)
+                    {
+                        emit_value(value_start_, value_size_ - 1);
+                        value_start_ = nullptr;
+                        value_size_ = 0;
+                    }
+                    else if (!state_stack_.empty() && state_stack_.back() == State::IN_ARRAY && value_start_ != nullptr)
+                    {
+                        emit_value(value_start_, value_size_ - 1);
+                    }
+
+                    if (!state_stack_.empty() && state_stack_.back() == State::IN_ARRAY)
+                    {
+                        // Next element may be a scalar even if the previous one was a container
+                        value_start_ = &c + 1;
+                        value_size_ = 0;
+                        array_string_size_ = 0;
+
+                        // A trailing comma is not followed by an element
+                        if (lenient_)
+                        {
+                            next_element_pending_ = true;
+                        }
+                        else
+                        {
+                            listener_->on_array_next_element();
+                        }
+                    }
+
+                    after_colon_ = false;
+                    break;
+                case Token::NONE:
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        report_partial_value();
+
+        // Return the required point to keep
+        size_t allow_to_remove = value_start_ ? value_start_ - chunk : size;
+
+        return allow_to_remove;
+    }
+
+    virtual void reset(IJSONListener & listener)
+    {
+        listener_ = &listener;
+        state_stack_.clear();
+        after_colon_ = false;
+        value_start_ = nullptr;
+        value_size_ = 0;
+        array_string_size_ = 0;
+        partial_size_ = 0;
+        escaped_ = false;
+        documents_ = 0;
+        comment_ = Comment::NONE;
+        resume_after_colon_ = false;
+        resume_value_ = false;
+        next_element_pending_ = false;
+    }
+
+    /**
+     * @brief Number of top-level documents completed since construction or last reset
+    */
+    size_t documents() const
+    {
+        return documents_;
+    }
+
+    /**
+     * @brief Opt-in lenient mode that skips line and block comments and trailing commas, as in JSONC
+    */
+    void set_lenient(bool lenient)
+    {
+        lenient_ = lenient;
+    }
+
+protected:
+
+    enum class State : uint8_t
+    {
+        IN_OBJECT,
+        IN_ARRAY,
+        IN_STRING,
+    };
+
+    enum class Token
+    {
+        OBJECT_START,
+        OBJECT_END,
+        ARRAY_START,
+        ARRAY_END,
+        QUOTE,
+        COLON,
+        COMMA,
+        NONE
+    };
+
+    using TokenMapType = std::array<std::pair<Token, char>, static_cast<size_t>(Token::NONE)>;
+    const TokenMapType token_map_ = {
+        std::make_pair(Token::OBJECT_START, '{'),
+        std::make_pair(Token::OBJECT_END, '}'),
+        std::make_pair(Token::ARRAY_START, '['),
+        std::make_pair(Token::ARRAY_END, ']'),
+        std::make_pair(Token::QUOTE, '"'),
+        std::make_pair(Token::COLON, ':'),
+        std::make_pair(Token::COMMA, ',')
+    };
+
+    enum class Comment : uint8_t
+    {
+        NONE,
+        SLASH,
+        LINE,
+        BLOCK,
+        BLOCK_STAR
+    };
+
+    static bool is_space(const char c)
+    {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    // Comments and deferred array separators outside strings, true if c is consumed
+    bool lenient_char(const char & c)
+    {
+        if (comment_ == Comment::SLASH)
+        {
+            // A lone slash is dropped
+            comment_ = (c == '/') ? Comment::LINE : (c == '*') ? Comment::BLOCK : Comment::NONE;
+            if (comment_ != Comment::NONE)
+            {
+                return true;
+            }
+            end_comment(&c);
+            value_size_ = resume_value_ ? 1 : value_size_;
+        }
+
+        if (c == '/')
+        {
+            begin_comment(&c);
+            return true;
+        }
+
+        if (next_element_pending_ && !is_space(c))
+        {
+            if (c != ']')
+            {
+                listener_->on_array_next_element();
+            }
+            next_element_pending_ = false;
+        }
+
+        return false;
+    }
+
+    void begin_comment(const char * slash)
+    {
+        comment_ = Comment::SLASH;
+
+        // A comment ends a pending scalar, whitespace only values start again after the comment
+        bool pending = value_start_ != nullptr && (after_colon_ || (!state_stack_.empty() && state_stack_.back() == State::IN_ARRAY));
+        bool blank = std::all_of(value_start_, value_start_ + (pending ? slash - value_start_ : 0), is_space);
+
+        if (pending && !blank)
+        {
+            emit_value(value_start_, slash - value_start_);
+            array_string_size_ = 0;
+        }
+
+        resume_after_colon_ = after_colon_ && blank;
+        resume_value_ = pending && blank;
+
+        // Nothing is kept while skipping the comment
+        after_colon_ = false;
+        value_start_ = nullptr;
+        value_size_ = 0;
+    }
+
+    // Next is the first byte after the comment
+    void end_comment(const char * next)
+    {
+        comment_ = Comment::NONE;
+        after_colon_ = resume_after_colon_;
+
+        if (resume_value_)
+        {
+            value_start_ = next;
+            value_size_ = 0;
+        }
+    }
+
+    // Skips the comment from position i, returns the last position consumed
+    size_t skip_comment(const char * chunk, size_t i, size_t size)
+    {
+        if (comment_ == Comment::LINE)
+        {
+            const char * end = static_cast<const char *>(memchr(chunk + i, '\n', size - i));
+            if (end == nullptr)
+            {
+                return size - 1;
+            }
+
+            end_comment(end + 1);
+            return end - chunk;
+        }
+
+        while (i < size)
+        {
+            if (comment_ == Comment::BLOCK_STAR)
+            {
+                if (chunk[i] == '/')
+                {
+                    end_comment(chunk + i + 1);
+                    return i;
+                }
+                comment_ = (chunk[i] == '*') ? Comment::BLOCK_STAR : Comment::BLOCK;
+                i++;
+                continue;
+            }
+
+            const char * star = static_cast<const char *>(memchr(chunk + i, '*', size - i));
+            if (star == nullptr)
+            {
+                return size - 1;
+            }
+
+            comment_ = Comment::BLOCK_STAR;
+            i = star - chunk + 1;
+        }
+
+        return size - 1;
+    }
+
+    void emit_value(const char * data, size_t size)
+    {
+        // Trim the surrounding whitespace, nothing is left for empty arrays
+        while (size > 0 && is_space(*data))
+        {
+            data++;
+            size--;
+        }
+
+        while (size > 0 && is_space(data[size - 1]))
+        {
+            size--;
+        }
+
+        if (size > 0)
+        {
+            listener_->on_raw_value(std::string_view(data, size));
+        }
+    }
+
+    void report_partial_value()
+    {
+        // Only strings in value position (after a colon or inside an array) are reported
+        size_t depth = state_stack_.size();
+        bool in_value_string = depth > 0 && state_stack_.back() == State::IN_STRING &&
+            (after_colon_ || (depth > 1 && state_stack_[depth - 2] == State::IN_ARRAY));
+
+        // Bytes received after the opening quote
+        size_t content_size = value_size_ - 1;
+
+        if (in_value_string && content_size > partial_size_)
+        {
+            listener_->on_partial_value(std::string_view(value_start_ + 1 + partial_size_, content_size - partial_size_));
+            partial_size_ = content_size;
+        }
+    }
+
+    void check_document_end()
+    {
+        // Closing the outermost container completes a document, so back-to-back
+        // documents ({...}{...}) can be streamed through the same parser
+        if (state_stack_.empty())
+        {
+            documents_++;
+            listener_->on_document_end();
+        }
+    }
+
+    Token get_token(const char c)
+    {
+        for (const auto & pair : token_map_)
+        {
+            if (pair.second == c)
+            {
+                return pair.first;
+            }
+        }
+
+        return Token::NONE;
+    }
+
+    IJSONListener * listener_;
+    IJSONListener dummy_listener_;
+
+    // State variables
+    std::vector<State> state_stack_;
+    bool after_colon_ = false;
+    char const * value_start_ = nullptr;
+    size_t value_size_ = 0;
+    size_t array_string_size_ = 0;
+    size_t partial_size_ = 0;
+    bool escaped_ = false;
+    size_t documents_ = 0;
+
+    // Lenient mode
+    bool lenient_ = false;
+    Comment comment_ = Comment::NONE;
+    bool resume_after_colon_ = false;
+    bool resume_value_ = false;
+    bool next_element_pending_ = false;
+};
+
+/**
+ * @class AutofeedStreamJson
+ *
+ * @brief A JSON parser that can be fed with chunks of data and automatically calls the feed method
+*/
+template<size_t CHUNK_SIZE>
+class AutofeedStreamJson : public StreamJson
+{
+public:
+    AutofeedStreamJson()
+    : StreamJson()
+    {
+    }
+
+    AutofeedStreamJson(IJSONListener & listener)
+    : StreamJson(listener)
+    {
+    }
+
+    void feed(const char * chunk, size_t size)
+    {
+        // Chunks larger than the free space are parsed in pieces
+        while (!failed_ && size > 0)
+        {
+            size_t piece = std::min(size, write_capacity());
+
+            // Copy new data to the buffer
+            memcpy(write_buffer(), chunk, piece);
+            commit(piece);
+
+            chunk += piece;
+            size -= piece;
+        }
+    };
+
+    /**
+     * @brief Free space at the end of the internal buffer
+     *
+     * Producers (e.g. decompressors) can write up to write_capacity() bytes here and parse them
+     * with commit(), avoiding the copy done by feed().
+    */
+    char * write_buffer()
+    {
+        return buffer_.data() + next_offset_;
+    }
+
+    size_t write_capacity() const
+    {
+        return failed_ ? 0 : CHUNK_SIZE - next_offset_;
+    }
+
+    /**
+     * @brief Parse size bytes already written at write_buffer()
+    */
+    void commit(size_t size)
+    {
+        if(!failed_)
+        {
+            // Actual size of the buffer
+            size += next_offset_;
+
+            // Feed the buffer
+            size_t to_remove = StreamJson::feed(buffer_.data(), size, next_offset_);
+
+            // Remove the processed data
+            memmove(buffer_.data(), buffer_.data() + to_remove, size - to_remove + 1);
+            next_offset_ = size - to_remove;
+
+            if (next_offset_ >= CHUNK_SIZE)
+            {
+                failed_ = true;
+            }
+        }
+    }
+
+    /**
+     * @brief True if a pending value did not fit in the buffer, no more data is parsed
+    */
+    bool failed() const
+    {
+        return failed_;
+    }
+
+    void reset(IJSONListener & listener)
+    {
+        StreamJson::reset(listener);
+        next_offset_ = 0;
+        failed_ = false;
+    }
+
+protected:
+
+    // One extra byte, values are classified including their delimiter
+    std::array<char, CHUNK_SIZE + 1> buffer_;
+    size_t next_offset_ = 0;
+    bool failed_ = false;
+};
+
+/**
+ * @class RawStreamJson
+ *
+ * @brief A chunk fed scanner that tracks the path of raw values and classifies them against a set of paths
+ *
+ * Paths use the same format as FilterListener queries, with `*` as wildcard for any key or index
+ * (e.g. "owners[*].name", "jobs[0]", "meta.*"). Values at a matching path are selected, containers that
+ * may hold a matching path are entered and everything else is passed over at scan speed, only looking
+ * for quotes and brackets. Derived classes decide what to do with the raw bytes through the hooks.
+*/
+class RawStreamJson
+{
+public:
+    static constexpr size_t MAX_PATHS = 64;
+
+    RawStreamJson(std::initializer_list<std::string_view> paths)
+    {
+        for (const auto & path : paths)
+        {
+            add_path(path);
+        }
+    }
+
+    virtual ~RawStreamJson() = default;
+
+    void feed(const char * chunk, size_t size)
+    {
+        size_t i = 0;
+
+        while (i < size)
+        {
+            if (in_value_)
+            {
+                if (scan_value(chunk, i, size))
+                {
+                    end_value(chunk, i);
+                }
+                continue;
+            }
+
+            const char c = chunk[i];
+
+            if (state_ != State::IN_KEY && (c == ' ' || c == '\n' || c == '\r' || c == '\t'))
+            {
+                i++;
+                continue;
+            }
+
+            switch (state_)
+            {
+                case State::EXPECT_VALUE:
+                    if (c == ']' || c == '}')
+                    {
+                        // Empty container
+                        close_level();
+                        i++;
+                    }
+                    else if (c == ',')
+                    {
+                        i++;
+                    }
+                    else
+                    {
+                        begin_value(chunk, i);
+                    }
+                    break;
+                case State::EXPECT_KEY:
+                    if (c == '"')
+                    {
+                        levels_.back().key.clear();
+                        key_escaped_ = false;
+                        state_ = State::IN_KEY;
+                    }
+                    else if (c == '}')
+                    {
+                        close_level();
+                    }
+                    i++;
+                    break;
+                case State::IN_KEY:
+                {
+                    // Keys are kept raw (escaped), they are usually short
+                    size_t start = i;
+                    for (; i < size; i++)
+                    {
+                        if (key_escaped_)
+                        {
+                            key_escaped_ = false;
+                        }
+                        else if (chunk[i] == '\\')
+                        {
+                            key_escaped_ = true;
+                        }
+                        else if (chunk[i] == '"')
+                        {
+                            break;
+                        }
+                    }
+
+                    levels_.back().key.append(chunk + start, i - start);
+
+                    if (i < size)
+                    {
+                        state_ = State::EXPECT_COLON;
+                        i++;
+                    }
+                    break;
+                }
+                case State::EXPECT_COLON:
+                    if (c == ':')
+                    {
+                        state_ = State::EXPECT_VALUE;
+                    }
+                    i++;
+                    break;
+                case State::AFTER_VALUE:
+                    if (c == ',')
+                    {
+                        Level & level = levels_.back();
+                        if (level.is_object)
+                        {
+                            state_ = State::EXPECT_KEY;
+                        }
+                        else
+                        {
+                            level.index++;
+                            state_ = State::EXPECT_VALUE;
+                        }
+                    }
+                    else if (c == '}' || c == ']')
+                    {
+                        close_level();
+                    }
+                    i++;
+                    break;
+            }
+        }
+
+        on_chunk_end(chunk, size);
+    }
+
+    virtual void reset()
+    {
+        levels_.clear();
+        state_ = State::EXPECT_VALUE;
+        in_value_ = false;
+        selected_ = false;
+        depth_ = 0;
+        in_string_ = false;
+        escaped_ = false;
+        key_escaped_ = false;
+    }
+
+protected:
+
+    struct Segment
+    {
+        enum class Type : uint8_t
+        {
+            KEY,
+            INDEX,
+            ANY
+        };
+
+        Type type;
+        std::string key;
+        size_t index = 0;
+    };
+
+    using Path = std::vector<Segment>;
+
+    struct Level
+    {
+        bool is_object;
+        uint64_t mask;      // Paths that may match below this container
+        std::string key;    // Current member key, for objects
+        size_t index = 0;   // Current element index, for arrays
+    };
+
+    enum class State : uint8_t
+    {
+        EXPECT_VALUE,
+        EXPECT_KEY,
+        IN_KEY,
+        EXPECT_COLON,
+        AFTER_VALUE,
+    };
+
+    RawStreamJson() = default;
+
+    // Paths beyond MAX_PATHS are ignored
+    void add_path(std::string_view path)
+    {
+        if (paths_.size() < MAX_PATHS)
+        {
+            paths_.push_back(parse_path(path));
+        }
+    }
+
+    // A value at a matching path starts at chunk[position]
+    virtual void on_select_begin(const char * chunk, size_t position, size_t path_index) {}
+
+    // The selected value ends right before chunk[position]
+    virtual void on_select_end(const char * chunk, size_t position) {}
+
+    // A container that may hold matching paths has been entered, it is levels_.back()
+    virtual void on_level_open() {}
+
+    // The container levels_.back() is about to be closed
+    virtual void on_level_close() {}
+
+    // A top-level value has been completed
+    virtual void on_document_end() {}
+
+    // All bytes of the chunk have been scanned
+    virtual void on_chunk_end(const char * chunk, size_t size) {}
+
+    static Path parse_path(std::string_view path)
+    {
+        Path segments;
+
+        while (!path.empty())
+        {
+            Segment segment;
+
+            if (path.front() == '[')
+            {
+                size_t end = path.find(']');
+                std::string_view index = path.substr(1, end == std::string_view::npos ? std::string_view::npos : end - 1);
+
+                segment.type = Segment::Type::INDEX;
+                if (index == "*" || std::from_chars(index.data(), index.data() + index.size(), segment.index).ec != std::errc())
+                {
+                    segment.type = Segment::Type::ANY;
+                }
+
+                path.remove_prefix(end == std::string_view::npos ? path.size() : end + 1);
+            }
+            else
+            {
+                if (path.front() == '.')
+                {
+                    path.remove_prefix(1);
+                }
+
+                size_t end = path.find_first_of(".[");
+                std::string_view key = path.substr(0, end);
+
+                segment.type = (key == "*") ? Segment::Type::ANY : Segment::Type::KEY;
+                segment.key = std::string(key);
+
+                path.remove_prefix(end == std::string_view::npos ? path.size() : end);
+            }
+
+            segments.push_back(segment);
+        }
+
+        return segments;
+    }
+
+    void begin_value(const char * chunk, size_t & i)
+    {
+        const char c = chunk[i];
+        const size_t depth = levels_.size();
+
+        // Paths that match up to this value
+        uint64_t candidates = 0;
+        size_t full_match = MAX_PATHS;
+
+        for (size_t p = 0; p < paths_.size(); p++)
+        {
+            if (depth > 0 && !((levels_.back().mask >> p) & 1))
+            {
+                continue;
+            }
+
+            const Path & path = paths_[p];
+            if (depth > 0 && !segment_matches(path[depth - 1], levels_.back()))
+            {
+                continue;
+            }
+
+            if (path.size() == depth)
+            {
+                full_match = std::min(full_match, p);
+            }
+            else
+            {
+                candidates |= uint64_t(1) << p;
+            }
+        }
+
+        if (full_match == MAX_PATHS && candidates != 0 && (c == '{' || c == '['))
+        {
+            levels_.push_back(Level{c == '{', candidates, std::string(), 0});
+            state_ = (c == '{') ? State::EXPECT_KEY : State::EXPECT_VALUE;
+            on_level_open();
+            i++;
+            return;
+        }
+
+        in_value_ = true;
+        selected_ = full_match != MAX_PATHS;
+        depth_ = 0;
+        in_string_ = false;
+        escaped_ = false;
+        scalar_ = c != '{' && c != '[' && c != '"';
+
+        if (selected_)
+        {
+            on_select_begin(chunk, i, full_match);
+        }
+    }
+
+    static bool segment_matches(const Segment & segment, const Level & level)
+    {
+        switch (segment.type)
+        {
+            case Segment::Type::KEY:
+                return level.is_object && level.key == segment.key;
+            case Segment::Type::INDEX:
+                return !level.is_object && level.index == segment.index;
+            default:
+                return true;
+        }
+    }
+
+    // Advance i over the current value, returns true once its last byte has been consumed
+    bool scan_value(const char * chunk, size_t & i, size_t size)
+    {
+        if (scalar_)
+        {
+            for (; i < size; i++)
+            {
+                const char c = chunk[i];
+                if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\n' || c == '\r' || c == '\t')
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        while (i < size)
+        {
+            if (escaped_)
+            {
+                escaped_ = false;
+                i++;
+            }
+            else if (in_string_)
+            {
+                i = detail::find_string_end(chunk, i, size);
+                if (i < size)
+                {
+                    escaped_ = chunk[i] == '\\';
+                    in_string_ = escaped_;
+                    i++;
+
+                    if (!in_string_ && depth_ == 0)
+                    {
+                        return true;
+                    }
+                }
+            }
+            else
+            {
+                i = detail::find_structural(chunk, i, size);
+                if (i < size)
+                {
+                    const char c = chunk[i];
+                    if (c == '"')
+                    {
+                        in_string_ = true;
+                    }
+                    else if (c == '{' || c == '[')
+                    {
+                        depth_++;
+                    }
+                    else
+                    {
+                        depth_--;
+                    }
+                    i++;
+
+                    if (!in_string_ && depth_ == 0)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void end_value(const char * chunk, size_t i)
+    {
+        in_value_ = false;
+
+        if (selected_)
+        {
+            selected_ = false;
+            on_select_end(chunk, i);
+        }
+
+        state_ = State::AFTER_VALUE;
+
+        if (levels_.empty())
+        {
+            state_ = State::EXPECT_VALUE;
+            on_document_end();
+        }
+    }
+
+    void close_level()
+    {
+        if (levels_.empty())
+        {
+            return;
+        }
+
+        on_level_close();
+        levels_.pop_back();
+
+        state_ = State::AFTER_VALUE;
+
+        if (levels_.empty())
+        {
+            state_ = State::EXPECT_VALUE;
+            on_document_end();
+        }
+    }
+
+    std::vector<Path> paths_;
+    std::vector<Level> levels_;
+
+    // State variables
+    State state_ = State::EXPECT_VALUE;
+    bool in_value_ = false;
+    bool selected_ = false;
+    bool scalar_ = false;
+    size_t depth_ = 0;
+    bool in_string_ = false;
+    bool escaped_ = false;
+    bool key_escaped_ = false;
+};
+
+/**
+ * @class ProjectionStreamJson
+ *
+ * @brief A pass-through stage that only emits the subtrees at the given paths
+ *
+ * Selected values are copied verbatim, without re-serialization, and the enclosing objects and arrays
+ * are emitted on demand so the output is valid JSON with the original structure. Array elements that
+ * do not hold any selected value are dropped. Each input document produces one output line.
+*/
+template<size_t BUFFER_SIZE>
+class ProjectionStreamJson : public RawStreamJson
+{
+public:
+    using SinkType = typename JSONWriter<BUFFER_SIZE>::SinkType;
+
+    ProjectionStreamJson(std::initializer_list<std::string_view> paths, SinkType sink)
+    : RawStreamJson(paths)
+    , writer_(sink)
+    {
+    }
+
+    void flush()
+    {
+        writer_.flush();
+    }
+
+    void reset() override
+    {
+        RawStreamJson::reset();
+        opened_.clear();
+        document_written_ = false;
+    }
+
+protected:
+
+    void on_select_begin(const char * chunk, size_t position, size_t /* path_index */) override
+    {
+        open_levels();
+
+        if (!levels_.empty() && levels_.back().is_object)
+        {
+            writer_.on_key(levels_.back().key);
+        }
+
+        writer_.write_raw(chunk + position, 0);
+        copy_start_ = position;
+        document_written_ = true;
+    }
+
+    void on_select_end(const char * chunk, size_t position) override
+    {
+        writer_.append_raw(chunk + copy_start_, position - copy_start_);
+    }
+
+    void on_level_open() override
+    {
+        opened_.push_back(false);
+    }
+
+    void on_level_close() override
+    {
+        if (opened_.back())
+        {
+            if (levels_.back().is_object)
+            {
+                writer_.on_object_end();
+            }
+            else
+            {
+                writer_.on_array_end();
+            }
+        }
+        opened_.pop_back();
+    }
+
+    void on_document_end() override
+    {
+        if (document_written_)
+        {
+            writer_.on_document_end();
+            document_written_ = false;
+        }
+    }
+
+    void on_chunk_end(const char * chunk, size_t size) override
+    {
+        // Selected value continues in the next chunk
+        if (selected_)
+        {
+            writer_.append_raw(chunk + copy_start_, size - copy_start_);
+        }
+        copy_start_ = 0;
+    }
+
+    void open_levels()
+    {
+        for (size_t l = 0; l < levels_.size(); l++)
+        {
+            if (!opened_[l])
+            {
+                if (l > 0 && levels_[l - 1].is_object)
+                {
+                    writer_.on_key(levels_[l - 1].key);
+                }
+
+                if (levels_[l].is_object)
+                {
+                    writer_.on_object_start();
+                }
+                else
+                {
+                    writer_.on_array_start();
+                }
+                opened_[l] = true;
+            }
+        }
+    }
+
+    JSONWriter<BUFFER_SIZE> writer_;
+    std::vector<bool> opened_;
+    size_t copy_start_ = 0;
+    bool document_written_ = false;
+};
+
+/**
+ * @class RedactionStreamJson
+ *
+ * @brief A pass-through stage that copies the input and replaces the values at the given paths
+ *
+ * Each rule is a path and the raw JSON bytes written instead of the matching values (e.g. "\"***\"").
+ * Untouched regions are forwarded to the sink as slices of the input chunks, without copies.
+*/
+class RedactionStreamJson : public RawStreamJson
+{
+public:
+    using SinkType = std::function<void(const char *, size_t)>;
+    using RuleType = std::pair<std::string_view, std::string_view>;
+
+    RedactionStreamJson(std::initializer_list<RuleType> rules, SinkType sink)
+    : sink_(sink)
+    {
+        for (const auto & rule : rules)
+        {
+            add_path(rule.first);
+            replacements_.push_back(std::string(rule.second));
+        }
+    }
+
+    void reset() override
+    {
+        RawStreamJson::reset();
+        copy_start_ = 0;
+    }
+
+protected:
+
+    void on_select_begin(const char * chunk, size_t position, size_t path_index) override
+    {
+        output(chunk + copy_start_, position - copy_start_);
+        output(replacements_[path_index].data(), replacements_[path_index].size());
+    }
+
+    void on_select_end(const char * chunk, size_t position) override
+    {
+        copy_start_ = position;
+    }
+
+    void on_chunk_end(const char * chunk, size_t size) override
+    {
+        if (!selected_)
+        {
+            output(chunk + copy_start_, size - copy_start_);
+        }
+        copy_start_ = 0;
+    }
+
+    void output(const char * data, size_t size)
+    {
+        if (size > 0)
+        {
+            sink_(data, size);
+        }
+    }
+
+    SinkType sink_;
+    std::vector<std::string> replacements_;
+    size_t copy_start_ = 0;
+};
+
+/**
+ * @class MinifyStreamJson
+ *
+ * @brief A pass-through stage that removes insignificant whitespace
+ *
+ * Bytes are compacted into an output buffer eight at a time when none of them is whitespace, a quote
+ * or a bracket, strings are copied verbatim. Each top-level document is written on its own line, and
+ * whitespace between top-level scalars (e.g. NDJSON numbers) is kept as a newline so they do not merge.
+ * Call flush() once done.
+*/
+template<size_t BUFFER_SIZE>
+class MinifyStreamJson
+{
+    static_assert(BUFFER_SIZE >= 16, "Output buffer is written eight bytes at a time");
+
+public:
+    using SinkType = std::function<void(const char *, size_t)>;
+
+    MinifyStreamJson(SinkType sink)
+    : sink_(sink)
+    {
+    }
+
+    void feed(const char * chunk, size_t size)
+    {
+        size_t i = 0;
+
+        while (i < size)
+        {
+            // Each input byte produces at most two output bytes (the byte and a newline)
+            if (BUFFER_SIZE - used_ < 16)
+            {
+                flush();
+            }
+
+            size_t end = i + std::min(size - i, (BUFFER_SIZE - used_) / 2);
+            i = compact(chunk, i, end);
+        }
+    }
+
+    void flush()
+    {
+        if (used_ > 0)
+        {
+            sink_(buffer_.data(), used_);
+            used_ = 0;
+        }
+    }
+
+    void reset()
+    {
+        used_ = 0;
+        depth_ = 0;
+        in_string_ = false;
+        escaped_ = false;
+        scalar_ = false;
+        separate_ = false;
+    }
+
+protected:
+
+    enum ByteClass : uint8_t
+    {
+        PLAIN,
+        SPACE,
+        QUOTE,
+        OPEN,
+        CLOSE,
+    };
+
+    static constexpr std::array<uint8_t, 256> BYTE_CLASS = []()
+    {
+        std::array<uint8_t, 256> table = {};
+        table[' '] = table['\n'] = table['\r'] = table['\t'] = SPACE;
+        table['"'] = QUOTE;
+        table['{'] = table['['] = OPEN;
+        table['}'] = table[']'] = CLOSE;
+        return table;
+    }();
+
+    // Compact chunk[i, end) into the buffer, which has room for twice that size
+    size_t compact(const char * chunk, size_t i, size_t end)
+    {
+        // Work on local copies, stores to the buffer may alias the members
+        char * out = buffer_.data() + used_;
+        size_t depth = depth_;
+        bool in_string = in_string_;
+        bool escaped = escaped_;
+        bool scalar = scalar_;
+        bool separate = separate_;
+
+        while (i < end)
+        {
+            if (in_string)
+            {
+                // Copy eight bytes at once up to the word holding a quote or a backslash
+                while (i + 8 <= end)
+                {
+                    uint64_t word = detail::load64(chunk + i);
+                    if (detail::has_byte(word, '"') | detail::has_byte(word, '\\'))
+                    {
+                        break;
+                    }
+                    memcpy(out, &word, 8);
+                    out += 8;
+                    i += 8;
+                }
+
+                size_t word_end = std::min(i + 8, end);
+                while (in_string && i < word_end)
+                {
+                    const char c = chunk[i++];
+                    *out++ = c;
+
+                    if (escaped)
+                    {
+                        escaped = false;
+                    }
+                    else if (c == '\\')
+                    {
+                        escaped = true;
+                    }
+                    else if (c == '"')
+                    {
+                        in_string = false;
+                        scalar = depth == 0;
+                    }
+                }
+                continue;
+            }
+
+            // Fast path, eight bytes without anything to remove or track
+            if (i + 8 <= end)
+            {
+                uint64_t word = detail::load64(chunk + i);
+
+                if (!(detail::has_less_than(word, 0x21) | detail::has_byte(word, '"') |
+                      detail::has_byte(word, '{') | detail::has_byte(word, '}') |
+                      detail::has_byte(word, '[') | detail::has_byte(word, ']')))
+                {
+                    if (depth == 0)
+                    {
+                        if (separate)
+                        {
+                            *out++ = '\n';
+                            separate = false;
+                        }
+                        scalar = true;
+                    }
+
+                    memcpy(out, &word, 8);
+                    out += 8;
+                    i += 8;
+                    continue;
+                }
+            }
+
+            // Otherwise the word is compacted byte by byte, whitespace removal is branchless
+            size_t word_end = std::min(i + 8, end);
+            while (!in_string && i < word_end)
+            {
+                const char c = chunk[i++];
+                const uint8_t byte_class = BYTE_CLASS[static_cast<unsigned char>(c)];
+
+                if (depth == 0)
+                {
+                    // Whitespace after a top-level scalar separates it from the next value
+                    if (byte_class == SPACE)
+                    {
+                        separate = separate || scalar;
+                        scalar = false;
+                    }
+                    else
+                    {
+                        if (separate)
+                        {
+                            *out++ = '\n';
+                            separate = false;
+                        }
+                        scalar = byte_class == PLAIN;
+                    }
+                }
+
+                *out = c;
+                out += byte_class != SPACE;
+
+                if (byte_class == QUOTE)
+                {
+                    in_string = true;
+                }
+                else if (byte_class == OPEN)
+                {
+                    depth++;
+                }
+                else if (byte_class == CLOSE && depth > 0 && --depth == 0)
+                {
+                    *out++ = '\n';
+                }
+            }
+        }
+
+        used_ = out - buffer_.data();
+        depth_ = depth;
+        in_string_ = in_string;
+        escaped_ = escaped;
+        scalar_ = scalar;
+        separate_ = separate;
+
+        return i;
+    }
+
+    SinkType sink_;
+    std::array<char, BUFFER_SIZE> buffer_;
+    size_t used_ = 0;
+
+    // State variables
+    size_t depth_ = 0;
+    bool in_string_ = false;
+    bool escaped_ = false;
+    bool scalar_ = false;
+    bool separate_ = false;
+};
+
+/**
+ * @class BinaryStreamJson
+ *
+ * @brief Base of the decoders of binary formats that can be fed with chunks of data and drive the same listeners as StreamJson
+ *
+ * Derived classes tell the size of the next item and decode it into keys, values and containers,
+ * the base splits the input into items and produces the events. Only an item split across chunks
+ * is buffered, and only until it is complete. Each top-level item is a document. An item (e.g. a
+ * string) over MAX_ITEM_SIZE bytes fails the decoder instead of being buffered.
+*/
+class BinaryStreamJson
+{
+public:
+    static constexpr size_t MAX_ITEM_SIZE = size_t(1) << 28;
+
+    BinaryStreamJson()
+    : listener_(&dummy_listener_)
+    {
+    }
+
+    BinaryStreamJson(IJSONListener & listener)
+    : listener_(&listener)
+    {
+    }
+
+    virtual ~BinaryStreamJson() = default;
+
+    void feed(const char * chunk, size_t size)
+    {
+        size_t i = 0;
+
+        // Complete an item split across chunks first
+        if (!pending_.empty() && !failed_)
+        {
+            // The header may be completed by any byte, including the last one of the chunk
+            size_t needed = next_item_size(pending_.data(), pending_.size());
+            while (needed == 0 && i < size && !failed_)
+            {
+                pending_ += chunk[i++];
+                needed = next_item_size(pending_.data(), pending_.size());
+            }
+
+            if (needed == 0 || failed_)
+            {
+                return;
+            }
+
+            size_t missing = std::min(needed - std::min(needed, pending_.size()), size - i);
+            pending_.append(chunk + i, missing);
+            i += missing;
+
+            if (pending_.size() < needed)
+            {
+                return;
+            }
+
+            decode_item(pending_.data());
+            pending_.clear();
+        }
+
+        while (i < size && !failed_)
+        {
+            size_t needed = next_item_size(chunk + i, size - i);
+
+            if (failed_)
+            {
+                return;
+            }
+
+            if (needed == 0 || needed > size - i)
+            {
+                pending_.assign(chunk + i, size - i);
+                return;
+            }
+
+            decode_item(chunk + i);
+            i += needed;
+        }
+    }
+
+    bool failed() const
+    {
+        return failed_;
+    }
+
+    /**
+     * @brief Number of top-level documents completed since construction or last reset
+    */
+    size_t documents() const
+    {
+        return documents_;
+    }
+
+    virtual void reset(IJSONListener & listener)
+    {
+        listener_ = &listener;
+        frames_.clear();
+        pending_.clear();
+        failed_ = false;
+        documents_ = 0;
+    }
+
+protected:
+
+    static constexpr uint64_t INDEFINITE = std::numeric_limits<uint64_t>::max();
+
+    struct Frame
+    {
+        bool is_map;
+        // Items expected and received, keys and values count apart in maps
+        uint64_t size;
+        uint64_t items;
+    };
+
+    // Whole size of the item starting at data, 0 while its header is incomplete (or on failure)
+    virtual size_t item_size(const char * data, size_t available) = 0;
+
+    size_t next_item_size(const char * data, size_t available)
+    {
+        size_t needed = item_size(data, available);
+
+        if (needed > MAX_ITEM_SIZE)
+        {
+            failed_ = true;
+            return 0;
+        }
+
+        return needed;
+    }
+
+    // Decodes a complete item
+    virtual void decode_item(const char * data) = 0;
+
+    static uint64_t load_be(const char * data, size_t size)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            value = (value << 8) | static_cast<unsigned char>(data[i]);
+        }
+        return value;
+    }
+
+    bool expecting_key() const
+    {
+        return !frames_.empty() && frames_.back().is_map && frames_.back().items % 2 == 0;
+    }
+
+    // Keys and strings are passed escaped, as StreamJson passes them
+    const std::string & escaped(const std::string_view & string)
+    {
+        detail::escape(string, escaped_);
+        return escaped_;
+    }
+
+    void key(const std::string_view & key)
+    {
+        listener_->on_key(escaped(key));
+        frames_.back().items++;
+    }
+
+    void string(const std::string_view & string)
+    {
+        if (expecting_key())
+        {
+            key(string);
+        }
+        else
+        {
+            value(JSONValue::from_string(escaped(string)));
+        }
+    }
+
+    void value(const JSONValue & value)
+    {
+        next_element();
+        listener_->on_value(value);
+        end_item();
+    }
+
+    void open(bool is_map, uint64_t entries)
+    {
+        next_element();
+        if (is_map)
+        {
+            listener_->on_object_start();
+        }
+        else
+        {
+            listener_->on_array_start();
+        }
+        frames_.push_back(Frame{is_map, (is_map && entries != INDEFINITE) ? 2 * entries : entries, 0});
+        close_frames();
+    }
+
+    // End of an indefinite length container
+    void close()
+    {
+        if (frames_.empty() || frames_.back().size != INDEFINITE || (frames_.back().is_map && frames_.back().items % 2 != 0))
+        {
+            failed_ = true;
+            return;
+        }
+
+        frames_.back().size = frames_.back().items;
+        close_frames();
+    }
+
+    void next_element()
+    {
+        if (!frames_.empty() && !frames_.back().is_map && frames_.back().items > 0)
+        {
+            listener_->on_array_next_element();
+        }
+    }
+
+    void end_item()
+    {
+        if (frames_.empty())
+        {
+            end_document();
+            return;
+        }
+
+        frames_.back().items++;
+        close_frames();
+    }
+
+    // Ends the containers whose items are all received
+    void close_frames()
+    {
+        while (!frames_.empty() && frames_.back().items == frames_.back().size)
+        {
+            if (frames_.back().is_map)
+            {
+                listener_->on_object_end();
+            }
+            else
+            {
+                listener_->on_array_end();
+            }
+            frames_.pop_back();
+
+            if (frames_.empty())
+            {
+                end_document();
+                return;
+            }
+            frames_.back().items++;
+        }
+    }
+
+    void end_document()
+    {
+        documents_++;
+        listener_->on_document_end();
+    }
+
+    IJSONListener * listener_;
+    IJSONListener dummy_listener_;
+
+    // State variables
+    std::vector<Frame> frames_;
+    std::string pending_;
+    std::string escaped_;
+    bool failed_ = false;
+    size_t documents_ = 0;
+};
+
+/**
+ * @class MessagePackStreamJson
+ *
+ * @brief A MessagePack decoder that can be fed with chunks of data and drives the same listeners as StreamJson
+ *
+ * Maps and arrays produce the same events as JSON objects and arrays, scalars are passed to
+ * IJSONListener::on_value() already typed so no text is parsed. Map keys that are not strings are
+ * converted to text, binary and extension payloads are passed as strings holding their bytes,
+ * unsigned integers above the int64_t range as floating values.
+*/
+class MessagePackStreamJson : public BinaryStreamJson
+{
+public:
+    using BinaryStreamJson::BinaryStreamJson;
+
+protected:
+
+    // Bytes of the type, length and fixed size value of an item, 0 if the type is never used
+    static size_t header_size(unsigned char type)
+    {
+        if (type <= 0xbf || type >= 0xe0)
+        {
+            return 1;
+        }
+
+        switch (type)
+        {
+            case 0xc0: case 0xc2: case 0xc3: return 1;
+            case 0xc4: case 0xd9: case 0xcc: case 0xd0: return 2;
+            case 0xc5: case 0xda: case 0xdc: case 0xde: case 0xcd: case 0xd1: return 3;
+            case 0xc6: case 0xdb: case 0xdd: case 0xdf: case 0xce: case 0xd2: case 0xca: return 5;
+            case 0xcf: case 0xd3: case 0xcb: return 9;
+            case 0xc7: return 3;
+            case 0xc8: return 4;
+            case 0xc9: return 6;
+            case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8: return 2;
+            default: return 0;
+        }
+    }
+
+    // Bytes after the header, container contents are separate items
+    static uint64_t payload_size(const char * data)
+    {
+        unsigned char type = static_cast<unsigned char>(data[0]);
+
+        if (type >= 0xa0 && type <= 0xbf)
+        {
+            return type & 0x1f;
+        }
+
+        switch (type)
+        {
+            case 0xc4: case 0xd9: return load_be(data + 1, 1);
+            case 0xc5: case 0xda: return load_be(data + 1, 2);
+            case 0xc6: case 0xdb: return load_be(data + 1, 4);
+            case 0xc7: return load_be(data + 1, 1);
+            case 0xc8: return load_be(data + 1, 2);
+            case 0xc9: return load_be(data + 1, 4);
+            case 0xd4: return 1;
+            case 0xd5: return 2;
+            case 0xd6: return 4;
+            case 0xd7: return 8;
+            case 0xd8: return 16;
+            default: return 0;
+        }
+    }
+
+    size_t item_size(const char * data, size_t available) override
+    {
+        size_t header = header_size(static_cast<unsigned char>(data[0]));
+
+        if (header == 0)
+        {
+            failed_ = true;
+            return 0;
+        }
+
+        return available < header ? 0 : header + payload_size(data);
+    }
+
+    void decode_item(const char * data) override
+    {
+        unsigned char type = static_cast<unsigned char>(data[0]);
+        size_t header = header_size(type);
+
+        // Containers
+        uint64_t entries = 0;
+        bool is_map = false;
+        bool is_container = true;
+
+        if (type >= 0x80 && type <= 0x8f)
+        {
+            entries = type & 0x0f;
+            is_map = true;
+        }
+        else if (type >= 0x90 && type <= 0x9f)
+        {
+            entries = type & 0x0f;
+        }
+        else if (type == 0xdc || type == 0xdd)
+        {
+            entries = load_be(data + 1, header - 1);
+        }
+        else if (type == 0xde || type == 0xdf)
+        {
+            entries = load_be(data + 1, header - 1);
+            is_map = true;
+        }
+        else
+        {
+            is_container = false;
+        }
+
+        if (is_container)
+        {
+            if (expecting_key())
+            {
+                failed_ = true;
+            }
+            else
+            {
+                open(is_map, entries);
+            }
+            return;
+        }
+
+        JSONValue scalar = decode_scalar(type, data, header);
+
+        if (scalar.type == JSONValue::Type::STRING)
+        {
+            string(scalar.string);
+        }
+        else if (expecting_key())
+        {
+            key(scalar.to_string());
+        }
+        else
+        {
+            value(scalar);
+        }
+    }
+
+    JSONValue decode_scalar(unsigned char type, const char * data, size_t header)
+    {
+        if (type <= 0x7f)
+        {
+            return JSONValue::from_integer(type);
+        }
+        if (type >= 0xe0)
+        {
+            return JSONValue::from_integer(static_cast<int8_t>(type));
+        }
+
+        std::string_view bytes(data + header, payload_size(data));
+
+        if ((type >= 0xa0 && type <= 0xbf) || (type >= 0xd9 && type <= 0xdb) || (type >= 0xc4 && type <= 0xc6))
+        {
+            return JSONValue::from_string(bytes);
+        }
+
+        switch (type)
+        {
+            case 0xc0:
+                return JSONValue::null();
+            case 0xc2:
+            case 0xc3:
+                return JSONValue::from_boolean(type == 0xc3);
+            case 0xca:
+                return JSONValue::from_floating(std::bit_cast<float>(static_cast<uint32_t>(load_be(data + 1, 4))));
+            case 0xcb:
+                return JSONValue::from_floating(std::bit_cast<double>(load_be(data + 1, 8)));
+            case 0xcc: case 0xcd: case 0xce: case 0xcf:
+            {
+                uint64_t value = load_be(data + 1, header - 1);
+                return value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) ?
+                    JSONValue::from_floating(static_cast<double>(value)) : JSONValue::from_integer(static_cast<int64_t>(value));
+            }
+            case 0xd0:
+                return JSONValue::from_integer(static_cast<int8_t>(load_be(data + 1, 1)));
+            case 0xd1:
+                return JSONValue::from_integer(static_cast<int16_t>(load_be(data + 1, 2)));
+            case 0xd2:
+                return JSONValue::from_integer(static_cast<int32_t>(load_be(data + 1, 4)));
+            case 0xd3:
+                return JSONValue::from_integer(static_cast<int64_t>(load_be(data + 1, 8)));
+            default:
+                // Extensions, the type byte is dropped
+                return JSONValue::from_string(bytes);
+        }
+    }
+};
+
+/**
+ * @class CborStreamJson
+ *
+ * @brief A CBOR decoder that can be fed with chunks of data and drives the same listeners as StreamJson
+ *
+ * Definite and indefinite length maps, arrays and strings are supported. Tags are skipped, the
+ * tagged item is decoded as usual. Map keys that are not strings are converted to text, byte
+ * strings are passed as strings holding their bytes, undefined as null and negative integers
+ * below the int64_t range as floating values.
+*/
+class CborStreamJson : public BinaryStreamJson
+{
+public:
+    using BinaryStreamJson::BinaryStreamJson;
+
+    void reset(IJSONListener & listener) override
+    {
+        BinaryStreamJson::reset(listener);
+        in_chunks_ = false;
+        chunks_.clear();
+    }
+
+protected:
+
+    enum Major : unsigned char
+    {
+        UNSIGNED = 0,
+        NEGATIVE = 1,
+        BYTES = 2,
+        TEXT = 3,
+        ARRAY = 4,
+        MAP = 5,
+        TAG = 6,
+        SIMPLE = 7
+    };
+
+    static constexpr unsigned char BREAK = 0xff;
+
+    // Bytes of the initial byte and the argument, 0 for reserved encodings
+    static size_t header_size(unsigned char initial)
+    {
+        unsigned char info = initial & 0x1f;
+
+        if (info < 24)
+        {
+            return 1;
+        }
+        if (info <= 27)
+        {
+            return 1 + (size_t(1) << (info - 24));
+        }
+        if (info == 31 && initial >> 5 != UNSIGNED && initial >> 5 != NEGATIVE && initial >> 5 != TAG)
+        {
+            return 1;
+        }
+        return 0;
+    }
+
+    static uint64_t argument(const char * data)
+    {
+        unsigned char info = static_cast<unsigned char>(data[0]) & 0x1f;
+        return info < 24 ? info : load_be(data + 1, header_size(static_cast<unsigned char>(data[0])) - 1);
+    }
+
+    static bool is_indefinite(const char * data)
+    {
+        return (static_cast<unsigned char>(data[0]) & 0x1f) == 31;
+    }
+
+    size_t item_size(const char * data, size_t available) override
+    {
+        unsigned char initial = static_cast<unsigned char>(data[0]);
+        size_t header = header_size(initial);
+
+        if (header == 0)
+        {
+            failed_ = true;
+            return 0;
+        }
+        if (available < header)
+        {
+            return 0;
+        }
+
+        bool is_string = (initial >> 5) == BYTES || (initial >> 5) == TEXT;
+        if (!is_string || is_indefinite(data))
+        {
+            return header;
+        }
+
+        // An 8 byte length may not fit in size_t together with the header
+        uint64_t length = argument(data);
+        if (length > std::numeric_limits<size_t>::max() - header)
+        {
+            failed_ = true;
+            return 0;
+        }
+
+        return header + length;
+    }
+
+    void decode_item(const char * data) override
+    {
+        unsigned char initial = static_cast<unsigned char>(data[0]);
+        unsigned char major = initial >> 5;
+        size_t header = header_size(initial);
+
+        // Chunks of an indefinite length string, definite strings of the same major type
+        if (in_chunks_)
+        {
+            if (initial == BREAK)
+            {
+                in_chunks_ = false;
+                string(chunks_);
+            }
+            else if (major == chunks_major_ && !is_indefinite(data))
+            {
+                chunks_.append(data + header, argument(data));
+            }
+            else
+            {
+                failed_ = true;
+            }
+            return;
+        }
+
+        switch (major)
+        {
+            case UNSIGNED:
+            {
+                uint64_t number = argument(data);
+                scalar(number > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) ?
+                    JSONValue::from_floating(static_cast<double>(number)) : JSONValue::from_integer(static_cast<int64_t>(number)));
+                break;
+            }
+            case NEGATIVE:
+            {
+                uint64_t number = argument(data);
+                scalar(number > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) ?
+                    JSONValue::from_floating(-1.0 - static_cast<double>(number)) : JSONValue::from_integer(-1 - static_cast<int64_t>(number)));
+                break;
+            }
+            case BYTES:
+            case TEXT:
+                if (is_indefinite(data))
+                {
+                    in_chunks_ = true;
+                    chunks_major_ = major;
+                    chunks_.clear();
+                }
+                else
+                {
+                    string(std::string_view(data + header, argument(data)));
+                }
+                break;
+            case ARRAY:
+            case MAP:
+                if (expecting_key())
+                {
+                    failed_ = true;
+                }
+                else
+                {
+                    open(major == MAP, is_indefinite(data) ? INDEFINITE : argument(data));
+                }
+                break;
+            case TAG:
+                // The tagged item follows
+                break;
+            default:
+                simple(data);
+                break;
+        }
+    }
+
+    void simple(const char * data)
+    {
+        unsigned char info = static_cast<unsigned char>(data[0]) & 0x1f;
+
+        switch (info)
+        {
+            case 20:
+            case 21:
+                scalar(JSONValue::from_boolean(info == 21));
+                break;
+            case 22:
+            case 23:
+                scalar(JSONValue::null());
+                break;
+            case 25:
+                scalar(JSONValue::from_floating(half_to_double(static_cast<uint16_t>(load_be(data + 1, 2)))));
+                break;
+            case 26:
+                scalar(JSONValue::from_floating(std::bit_cast<float>(static_cast<uint32_t>(load_be(data + 1, 4)))));
+                break;
+            case 27:
+                scalar(JSONValue::from_floating(std::bit_cast<double>(load_be(data + 1, 8))));
+                break;
+            case 31:
+                close();
+                break;
+            default:
+                // Unassigned simple values
+                scalar(JSONValue::from_integer(info < 24 ? info : argument(data)));
+                break;
+        }
+    }
+
+    static double half_to_double(uint16_t half)
+    {
+        int exponent = (half >> 10) & 0x1f;
+        double mantissa = half & 0x3ff;
+        double value = exponent == 0 ? std::ldexp(mantissa, -24) :
+            exponent == 31 ? (mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN()) :
+            std::ldexp(mantissa + 1024, exponent - 25);
+        return (half & 0x8000) ? -value : value;
+    }
+
+    void scalar(const JSONValue & scalar)
+    {
+        if (expecting_key())
+        {
+            key(scalar.to_string());
+        }
+        else
+        {
+            value(scalar);
+        }
+    }
+
+    // State variables
+    bool in_chunks_ = false;
+    unsigned char chunks_major_ = TEXT;
+    std::string chunks_;
+};
+
+/**
+ * @class BinaryWriter
+ *
+ * @brief Base of the JSON listeners that transcode the received events into a binary format
+ *
+ * Raw values are converted straight from their bytes: strings are only unescaped when they hold a
+ * backslash and numbers are parsed without building a JSONValue. Keys and strings are taken as
+ * JSON escaped text, as StreamJson passes them.
+*/
+class BinaryWriter : public IJSONListener
+{
+public:
+    using SinkType = std::function<void(const char *, size_t)>;
+
+    BinaryWriter(SinkType sink)
+    : sink_(sink)
+    {
+    }
+
+    void on_key(const std::string_view & key) override
+    {
+        write_key(unescaped(key));
+    }
+
+    void on_value(const JSONValue & value) override
+    {
+        switch (value.type)
+        {
+            case JSONValue::Type::STRING:
+                write_string(unescaped(value.string));
+                break;
+            case JSONValue::Type::FLOATING:
+                write_floating(value.floating);
+                break;
+            case JSONValue::Type::INTEGER:
+                write_integer(value.integer);
+                break;
+            case JSONValue::Type::BOOLEAN:
+                write_boolean(value.boolean);
+                break;
+            default:
+                write_null();
+                break;
+        }
+    }
+
+    void on_raw_value(const std::string_view & raw) override
+    {
+        // Other spellings of the literals (True, TRUE, None...) are left to the JSONValue classification
+        int64_t integer;
+        double floating;
+
+        if (raw.front() == '"')
+        {
+            write_string(unescaped(raw.substr(1, raw.size() - 2)));
+        }
+        else if (raw == "true" || raw == "false")
+        {
+            write_boolean(raw.front() == 't');
+        }
+        else if (raw == "null")
+        {
+            write_null();
+        }
+        else if (detail::parse_integer(raw, integer))
+        {
+            write_integer(integer);
+        }
+        else if (detail::parse_number(raw, floating))
+        {
+            write_floating(floating);
+        }
+        else
+        {
+            on_value(JSONValue(raw));
+        }
+    }
+
+protected:
+
+    virtual void write_key(const std::string_view & key) = 0;
+    virtual void write_string(const std::string_view & string) = 0;
+    virtual void write_integer(int64_t integer) = 0;
+    virtual void write_floating(double floating) = 0;
+    virtual void write_boolean(bool boolean) = 0;
+    virtual void write_null() = 0;
+
+    std::string_view unescaped(const std::string_view & raw)
+    {
+        if (memchr(raw.data(), '\\', raw.size()) == nullptr)
+        {
+            return raw;
+        }
+
+        detail::unescape(raw, unescaped_);
+        return unescaped_;
+    }
+
+    SinkType sink_;
+    std::string unescaped_;
+};
+
+/**
+ * @class CborWriter
+ *
+ * @brief A JSON listener that transcodes the received events into CBOR through a buffered output sink
+ *
+ * Objects and arrays are written with indefinite lengths, so nothing needs to be known in advance and
+ * memory is bounded by BUFFER_SIZE. Documents are written one after another (a CBOR sequence), floating
+ * values as single precision when that is exact. Call flush() once done.
+*/
+template<size_t BUFFER_SIZE>
+class CborWriter : public BinaryWriter
+{
+public:
+    static_assert(BUFFER_SIZE >= 16, "BUFFER_SIZE must hold the largest item header");
+
+    using BinaryWriter::BinaryWriter;
+
+    void on_object_start() override
+    {
+        put(0xbf);
+    }
+
+    void on_object_end() override
+    {
+        put(0xff);
+    }
+
+    void on_array_start() override
+    {
+        put(0x9f);
+    }
+
+    void on_array_end() override
+    {
+        put(0xff);
+    }
+
+    void flush()
+    {
+        if (used_ > 0)
+        {
+            sink_(buffer_.data(), used_);
+            used_ = 0;
+        }
+    }
+
+protected:
+
+    void write_key(const std::string_view & key) override
+    {
+        write_string(key);
+    }
+
+    void write_string(const std::string_view & string) override
+    {
+        head(3, string.size());
+        write(string.data(), string.size());
+    }
+
+    void write_integer(int64_t integer) override
+    {
+        if (integer >= 0)
+        {
+            head(0, static_cast<uint64_t>(integer));
+        }
+        else
+        {
+            head(1, static_cast<uint64_t>(-1 - integer));
+        }
+    }
+
+    void write_floating(double floating) override
+    {
+        float single = static_cast<float>(floating);
+
+        if (static_cast<double>(single) == floating || std::isnan(floating))
+        {
+            put(0xfa);
+            put_be(std::bit_cast<uint32_t>(single), 4);
+        }
+        else
+        {
+            put(0xfb);
+            put_be(std::bit_cast<uint64_t>(floating), 8);
+        }
+    }
+
+    void write_boolean(bool boolean) override
+    {
+        put(boolean ? 0xf5 : 0xf4);
+    }
+
+    void write_null() override
+    {
+        put(0xf6);
+    }
+
+    // Major type and argument in the shortest form
+    void head(uint8_t major, uint64_t argument)
+    {
+        major <<= 5;
+
+        if (argument < 24)
+        {
+            put(major | static_cast<uint8_t>(argument));
+        }
+        else if (argument <= 0xff)
+        {
+            put(major | 24);
+            put_be(argument, 1);
+        }
+        else if (argument <= 0xffff)
+        {
+            put(major | 25);
+            put_be(argument, 2);
+        }
+        else if (argument <= 0xffffffff)
+        {
+            put(major | 26);
+            put_be(argument, 4);
+        }
+        else
+        {
+            put(major | 27);
+            put_be(argument, 8);
+        }
+    }
+
+    void put(uint8_t byte)
+    {
+        if (used_ == BUFFER_SIZE)
+        {
+            flush();
+        }
+        buffer_[used_++] = static_cast<char>(byte);
+    }
+
+    void put_be(uint64_t value, size_t size)
+    {
+        for (size_t i = size; i > 0; i--)
+        {
+            put(static_cast<uint8_t>(value >> (8 * (i - 1))));
+        }
+    }
+
+    void write(const char * data, size_t size)
+    {
+        if (size > BUFFER_SIZE - used_)
+        {
+            flush();
+
+            // Too big to be buffered
+            if (size >= BUFFER_SIZE)
+            {
+                sink_(data, size);
+                return;
+            }
+        }
+
+        memcpy(buffer_.data() + used_, data, size);
+        used_ += size;
+    }
+
+    std::array<char, BUFFER_SIZE> buffer_;
+    size_t used_ = 0;
+};
+
+/**
+ * @class MessagePackWriter
+ *
+ * @brief A JSON listener that transcodes the received events into MessagePack, one document at a time
+ *
+ * MessagePack containers start with their number of items, so maps and arrays are written with
+ * 32 bit headers that are patched when they end. A document is kept until it ends, then passed to
+ * the sink, memory is bounded by the largest document. A top-level string is written as a document
+ * of its own and an unbalanced end is ignored.
+*/
+class MessagePackWriter : public BinaryWriter
+{
+public:
+    using BinaryWriter::BinaryWriter;
+
+    void on_object_start() override
+    {
+        open(0xdf);
+    }
+
+    void on_object_end() override
+    {
+        close();
+    }
+
+    void on_array_start() override
+    {
+        open(0xdd);
+    }
+
+    void on_array_end() override
+    {
+        close();
+    }
 
-        aggregate_key_ += (aggregate_key_.size() ? "." : "");
-        if (key_.empty())
+    void on_document_end() override
+    {
+        if (!document_.empty())
         {
-            aggregate_key_ += "_";
+            sink_(document_.data(), document_.size());
+            document_.clear();
         }
-        else
+    }
+
+protected:
+
+    struct Frame
+    {
+        // Position of the header to patch
+        size_t offset;
+        uint32_t items;
+        bool is_map;
+    };
+
+    void write_key(const std::string_view & key) override
+    {
+        if (frames_.empty())
         {
-            aggregate_key_ += std::string(key_.data(), key_.size());
+            // A top-level string is reported as a key and never ends its document
+            string(key);
+            on_document_end();
+            return;
         }
 
-        key_.clear();
-    };
+        frames_.back().items++;
+        string(key);
+    }
 
-    void on_object_end() override {
-        size_t pos = aggregate_key_.rfind(".");
+    void write_string(const std::string_view & value) override
+    {
+        item();
+        string(value);
+    }
 
-        if (pos != std::string::npos)
+    void write_integer(int64_t integer) override
+    {
+        item();
+
+        if (integer >= -32 && integer <= 127)
         {
-            aggregate_key_ = aggregate_key_.substr(0, pos);
+            put(static_cast<uint8_t>(integer));
+        }
+        else if (integer >= std::numeric_limits<int32_t>::min() && integer <= std::numeric_limits<int32_t>::max())
+        {
+            put(0xd2);
+            put_be(static_cast<uint32_t>(integer), 4);
         }
         else
         {
-            aggregate_key_.clear();
+            put(0xd3);
+            put_be(static_cast<uint64_t>(integer), 8);
         }
-    };
+    }
 
-    void on_array_start() override {
+    void write_floating(double floating) override
+    {
+        item();
+        put(0xcb);
+        put_be(std::bit_cast<uint64_t>(floating), 8);
+    }
 
-        array_depth_.push_back(0);
+    void write_boolean(bool boolean) override
+    {
+        item();
+        put(boolean ? 0xc3 : 0xc2);
+    }
 
-        aggregate_key_ += (aggregate_key_.size() ? "." : "");
+    void write_null() override
+    {
+        item();
+        put(0xc0);
+    }
 
-        if (key_.empty())
-        {
-            aggregate_key_ += "_";
-        }
-        else
+    // Values count as items of arrays, keys as items of maps
+    void item()
+    {
+        if (!frames_.empty() && !frames_.back().is_map)
         {
-            aggregate_key_ += std::string(key_.data(), key_.size());
+            frames_.back().items++;
         }
+    }
 
-        aggregate_key_ += "[" + std::to_string(array_depth_.back()) + "]";
-
-        key_.clear();
-    };
+    void open(uint8_t type)
+    {
+        item();
+        frames_.push_back(Frame{document_.size(), 0, type == 0xdf});
+        put(type);
+        put_be(0, 4);
+    }
 
-    void on_array_end() override {
-        array_depth_.pop_back();
+    void close()
+    {
+        if (frames_.empty())
+        {
+            return;
+        }
 
-        size_t pos = aggregate_key_.rfind(".");
+        uint32_t items = frames_.back().items;
+        char * header = document_.data() + frames_.back().offset + 1;
+        for (size_t i = 0; i < 4; i++)
+        {
+            header[i] = static_cast<char>(items >> (8 * (3 - i)));
+        }
+        frames_.pop_back();
+    }
 
-        if (pos != std::string::npos)
+    void string(const std::string_view & string)
+    {
+        if (string.size() < 32)
         {
-            aggregate_key_ = aggregate_key_.substr(0, pos);
+            put(0xa0 | static_cast<uint8_t>(string.size()));
+        }
+        else if (string.size() <= 0xff)
+        {
+            put(0xd9);
+            put_be(string.size(), 1);
+        }
+        else if (string.size() <= 0xffff)
+        {
+            put(0xda);
+            put_be(string.size(), 2);
         }
         else
         {
-            aggregate_key_.clear();
+            put(0xdb);
+            put_be(string.size(), 4);
         }
-    };
-
-    void on_array_next_element() override {
-        array_depth_.back()++;
-
-        aggregate_key_ = aggregate_key_.substr(0, aggregate_key_.rfind("[")) + "[" + std::to_string(array_depth_.back()) + "]";
-    };
+        document_.append(string.data(), string.size());
+    }
 
-    void on_key(const std::string_view& string) override {
-        key_ = std::string(string.data(), string.size());
-    };
+    void put(uint8_t byte)
+    {
+        document_ += static_cast<char>(byte);
+    }
 
-    void on_value(const JSONValue & /* value */) override {
-        if(!key_.empty())
+    void put_be(uint64_t value, size_t size)
+    {
+        for (size_t i = size; i > 0; i--)
         {
-            // Got a key and a value
-            key_.clear();
+            document_ += static_cast<char>(value >> (8 * (i - 1)));
         }
-    };
+    }
 
-protected:
-    std::string key_;
-    std::string aggregate_key_;
-    std::vector<size_t> array_depth_;
+    // State variables
+    std::string document_;
+    std::vector<Frame> frames_;
 };
 
 /**
- * @class FilterListener
+ * @class SSEDecoder
  *
- * @brief A JSON listener that filters keys based on a string and calls a callback on match
+ * @brief A Server-Sent Events framing stage that forwards the payload of `data:` lines to a parser
+ *
+ * Payload slices are passed straight from the incoming chunk to the parser, so the only copy is the
+ * one done by the parser itself. Lines of the same event are joined with a newline, which is
+ * insignificant whitespace for JSON. Every event is expected to carry a complete JSON document, except
+ * an end of stream sentinel set with set_sentinel() (e.g. "[DONE]"), which is never fed to the parser.
 */
-template<CTRE_REGEX_INPUT_TYPE filter>
-struct FilterListener : public JSONListener
+template<typename ParserType>
+class SSEDecoder
 {
-    using CallBackType = std::function<void(const std::string_view &, const JSONValue &, const std::vector<size_t>&)>;
+public:
+    using EventCallBackType = std::function<void()>;
 
-    FilterListener(CallBackType callback)
-    : callback_(callback)
+    SSEDecoder(ParserType & parser)
+    : parser_(parser)
     {
     }
 
-    void on_value(const JSONValue & value) override {
+    SSEDecoder(ParserType & parser, EventCallBackType callback)
+    : parser_(parser)
+    , callback_(callback)
+    {
+    }
 
-        // Find and replace "_."
-        std::string query = aggregate_key_ + "." + key_;
-        size_t pos = query.find("_.");
-        while (pos != std::string::npos)
-        {
-            query.replace(pos, 2, "");
-            pos = query.find("_.");
-        }
+    void feed(const char * chunk, size_t size)
+    {
+        size_t i = 0;
 
-        if (ctre::match<filter>(std::string_view(query)))
+        while (i < size)
         {
-            callback_(query, value, array_depth_);
-        }
+            const char c = chunk[i];
 
-        JSONListener::on_value(value);
-    }
+            // A CR may be followed by a LF in the next chunk, both are a single line end
+            if (skip_lf_)
+            {
+                skip_lf_ = false;
+                if (c == '\n')
+                {
+                    i++;
+                    continue;
+                }
+            }
 
-protected:
+            switch (state_)
+            {
+                case State::LINE_START:
+                    if (c == '\r' || c == '\n')
+                    {
+                        dispatch_event();
+                        end_line(c);
+                        i++;
+                        break;
+                    }
+                    field_size_ = 0;
+                    field_is_data_ = true;
+                    state_ = State::FIELD;
+                    [[fallthrough]];
+                case State::FIELD:
+                    if (c == ':' || c == '\r' || c == '\n')
+                    {
+                        // Comments (empty field name) and other fields are ignored
+                        bool is_data = field_is_data_ && field_size_ == DATA_FIELD.size();
 
-    // const std::string filter_;
+                        if (is_data)
+                        {
+                            start_data_line();
+                        }
 
-    CallBackType callback_;
-};
+                        if (c == ':')
+                        {
+                            state_ = is_data ? State::VALUE_START : State::IGNORE;
+                        }
+                        else
+                        {
+                            end_line(c);
+                        }
+                    }
+                    else
+                    {
+                        field_is_data_ = field_is_data_ && field_size_ < DATA_FIELD.size() && DATA_FIELD[field_size_] == c;
+                        field_size_++;
+                    }
+                    i++;
+                    break;
+                case State::VALUE_START:
+                    // A single space after the colon is not part of the value
+                    state_ = State::DATA;
+                    if (c == ' ')
+                    {
+                        i++;
+                    }
+                    break;
+                case State::DATA:
+                case State::IGNORE:
+                {
+                    size_t end = find_line_end(chunk, i, size);
 
-/**
- * @class MultiListener
- *
- * @brief A JSON listener that acts as a multiplexer
-*/
-class MultiListener : public IJSONListener
-{
-public:
-    MultiListener() = default;
+                    if (state_ == State::DATA && end > i)
+                    {
+                        forward(chunk + i, end - i);
+                    }
 
-    MultiListener(std::initializer_list<IJSONListener *> listeners)
-    : listeners_(listeners)
+                    if (end < size)
+                    {
+                        end_line(chunk[end]);
+                        end++;
+                    }
+
+                    i = end;
+                    break;
+                }
+            }
+        }
+    }
+
+    void reset()
     {
+        state_ = State::LINE_START;
+        skip_lf_ = false;
+        event_has_data_ = false;
+        events_ = 0;
+        sentinel_match_ = 0;
+        done_ = false;
     }
 
-    void on_object_start() override
+    /**
+     * @brief Sets the data of the event that ends the stream (e.g. "[DONE]"), empty for none
+     *
+     * The start of every event is held back while it matches the sentinel, so at most its size is buffered.
+    */
+    void set_sentinel(const std::string_view & sentinel)
     {
-        for (auto listener : listeners_)
-        {
-            listener->on_object_start();
-        }
-    };
-    void on_object_end() override
+        sentinel_ = std::string(sentinel);
+    }
+
+    /**
+     * @brief Number of events carrying data dispatched since construction or last reset, without the sentinel
+    */
+    size_t events() const
     {
-        for (auto listener : listeners_)
-        {
-            listener->on_object_end();
-        }
-    };
-    void on_array_start() override
+        return events_;
+    }
+
+    /**
+     * @brief True once the sentinel event was received
+    */
+    bool done() const
     {
-        for (auto listener : listeners_)
-        {
-            listener->on_array_start();
-        }
+        return done_;
+    }
+
+protected:
+
+    enum class State : uint8_t
+    {
+        LINE_START,
+        FIELD,
+        VALUE_START,
+        DATA,
+        IGNORE,
     };
-    void on_array_end() override
+
+    static constexpr std::string_view DATA_FIELD = "data";
+
+    static size_t find_line_end(const char * chunk, size_t begin, size_t size)
     {
-        for (auto listener : listeners_)
+        const char * lf = static_cast<const char *>(memchr(chunk + begin, '\n', size - begin));
+        size_t end = lf ? lf - chunk : size;
+
+        const char * cr = static_cast<const char *>(memchr(chunk + begin, '\r', end - begin));
+        return cr ? cr - chunk : end;
+    }
+
+    void start_data_line()
+    {
+        // Consecutive data lines of an event are joined by a newline
+        if (event_has_data_)
         {
-            listener->on_array_end();
+            forward("\n", 1);
         }
-    };
-    void on_array_next_element() override
-    {
-        for (auto listener : listeners_)
+        else
         {
-            listener->on_array_next_element();
+            sentinel_match_ = sentinel_.empty() ? NO_SENTINEL : 0;
         }
-    };
-    void on_key(const std::string_view& key) override
+        event_has_data_ = true;
+    }
+
+    void forward(const char * data, size_t size)
     {
-        for (auto listener : listeners_)
+        if (sentinel_match_ != NO_SENTINEL)
         {
-            listener->on_key(key);
+            size_t matched = std::min(size, sentinel_.size() - sentinel_match_);
+
+            if (matched == size && memcmp(data, sentinel_.data() + sentinel_match_, size) == 0)
+            {
+                // Still a prefix of the sentinel, held back
+                sentinel_match_ += size;
+                return;
+            }
+
+            release_sentinel();
         }
-    };
-    void on_value(const JSONValue& value) override
+
+        parser_.feed(data, size);
+    }
+
+    void release_sentinel()
     {
-        for (auto listener : listeners_)
+        // The held back bytes are the same as the start of the sentinel
+        if (sentinel_match_ != NO_SENTINEL && sentinel_match_ > 0)
         {
-            listener->on_value(value);
+            parser_.feed(sentinel_.data(), sentinel_match_);
         }
-    };
+        sentinel_match_ = NO_SENTINEL;
+    }
 
-    void add_listener(IJSONListener & listener)
+    void end_line(const char c)
     {
-        listeners_.push_back(&listener);
+        skip_lf_ = c == '\r';
+        state_ = State::LINE_START;
     }
 
-private:
-    std::vector<IJSONListener *> listeners_;
+    void dispatch_event()
+    {
+        if (event_has_data_)
+        {
+            event_has_data_ = false;
+
+            if (sentinel_match_ != NO_SENTINEL && sentinel_match_ == sentinel_.size())
+            {
+                sentinel_match_ = NO_SENTINEL;
+                done_ = true;
+                return;
+            }
+
+            release_sentinel();
+            events_++;
+
+            if (callback_)
+            {
+                callback_();
+            }
+        }
+    }
+
+    static constexpr size_t NO_SENTINEL = std::numeric_limits<size_t>::max();
+
+    ParserType & parser_;
+    EventCallBackType callback_;
+    std::string sentinel_;
+
+    // State variables
+    State state_ = State::LINE_START;
+    size_t field_size_ = 0;
+    bool field_is_data_ = false;
+    bool skip_lf_ = false;
+    bool event_has_data_ = false;
+    size_t events_ = 0;
+    size_t sentinel_match_ = NO_SENTINEL;
+    bool done_ = false;
 };
 
 /**
- * @class StreamJson
+ * @class ChunkedDecoder
  *
- * @brief A JSON parser that can be fed with chunks of data
+ * @brief An HTTP chunked transfer-encoding decoding stage that forwards chunk payloads to a parser
+ *
+ * The decoder is fed with the HTTP body as it is read from the connection. Chunk headers, extensions
+ * and trailers may straddle reads, payload slices are passed straight to the parser.
 */
-class StreamJson {
+template<typename ParserType>
+class ChunkedDecoder
+{
 public:
-    StreamJson()
-    : listener_(&dummy_listener_)
-    {
-    }
-
-    StreamJson(IJSONListener & listener)
-    : listener_(&listener)
+    ChunkedDecoder(ParserType & parser)
+    : parser_(parser)
     {
     }
 
-    size_t feed(const char * chunk, size_t size, size_t offset = 0)
+    void feed(const char * chunk, size_t size)
     {
-        if (offset != 0)
-        {
-            value_start_ = chunk;
-            value_size_ = offset - 1;
-        }
-        else if(after_colon_)
-        {
-            value_start_ = chunk;
-            value_size_ = 0;
-        }
+        size_t i = 0;
 
-        for (size_t i = offset; i < size; i++)
+        while (i < size && state_ != State::DONE && state_ != State::FAILED)
         {
-            const char & c = *(chunk + i);
-
-            Token token = get_token(c);
-
-            value_size_++;
-
-            // If we are processing a string, the only valid token is the quote
-            if (!state_stack_.empty() && state_stack_.back() == State::IN_STRING && token != Token::QUOTE)
-            {
-                continue;
-            }
+            const char c = chunk[i];
 
-            switch (token)
+            switch (state_)
             {
-                case Token::QUOTE:
-                    // If we are in a string, we are going to end it
-                    if (state_stack_.back() == State::IN_STRING)
+                case State::SIZE:
+                {
+                    // Leading zeros do not count towards the limit of significant digits
+                    int digit = hex_value(c);
+                    if (digit >= 0 && std::bit_width(remaining_) <= 4 * (MAX_SIZE_DIGITS - 1))
                     {
-                        state_stack_.pop_back();
-
-                        // If this string is after a colon, it is a value
-                        if (after_colon_)
-                        {
-                            after_colon_ = false;
-                            listener_->on_value(JSONValue(value_start_, value_size_));
-                        }
-                        else
-                        {
-                            listener_->on_key(std::string_view(value_start_ + 1, value_size_ - 1));
-                        }
-
-                        value_start_ = nullptr;
-                        value_size_ = 0;
+                        remaining_ = (remaining_ << 4) | static_cast<size_t>(digit);
+                        size_digits_++;
+                    }
+                    else if (size_digits_ > 0 && (c == ';' || c == ' ' || c == '\t'))
+                    {
+                        state_ = State::EXTENSION;
+                    }
+                    else if (size_digits_ > 0 && (c == '\r' || c == '\n'))
+                    {
+                        end_size_line(c);
                     }
                     else
                     {
-                        value_start_ = &c;
-                        value_size_ = 0;
-                        state_stack_.push_back(State::IN_STRING);
+                        state_ = State::FAILED;
                     }
+                    i++;
                     break;
-                case Token::OBJECT_START:
-                    after_colon_ = false;
-                    listener_->on_object_start();
-                    state_stack_.push_back(State::IN_OBJECT);
-                    break;
-                case Token::OBJECT_END:
-                    if( after_colon_)
+                }
+                case State::EXTENSION:
+                    // Chunk extensions are ignored
+                    if (c == '\r' || c == '\n')
                     {
-                        listener_->on_value(JSONValue(value_start_, value_size_ - 1));
+                        end_size_line(c);
                     }
-                    after_colon_ = false;
-                    if(state_stack_.back() == State::IN_OBJECT)
+                    i++;
+                    break;
+                case State::SIZE_LF:
+                    state_ = (remaining_ == 0) ? State::TRAILER_LINE_START : State::DATA;
+                    if (c == '\n')
                     {
-                        listener_->on_object_end();
-                        state_stack_.pop_back();
+                        i++;
                     }
-                    value_start_ = nullptr;
-                    value_size_ = 0;
-                    break;
-                case Token::ARRAY_START:
-                    after_colon_ = false;
-                    value_start_ = &c + 1;
-                    value_size_ = 0;
-                    listener_->on_array_start();
-                    state_stack_.push_back(State::IN_ARRAY);
                     break;
-                case Token::ARRAY_END:
-                    after_colon_ = false;
+                case State::DATA:
+                {
+                    size_t available = std::min(remaining_, size - i);
+                    parser_.feed(chunk + i, available);
+                    remaining_ -= available;
+                    i += available;
 
-                    if(value_start_ != nullptr)
+                    if (remaining_ == 0)
                     {
-                        listener_->on_value(JSONValue(value_start_, value_size_ - 1));
-                        value_start_ = nullptr;
-                        value_size_ = 0;
+                        state_ = State::DATA_CR;
                     }
-
-                    if(state_stack_.back() == State::IN_ARRAY)
+                    break;
+                }
+                case State::DATA_CR:
+                    if (c == '\r')
                     {
-                        listener_->on_array_end();
-                        state_stack_.pop_back();
+                        state_ = State::DATA_LF;
+                    }
+                    else if (c == '\n')
+                    {
+                        start_chunk();
+                    }
+                    else
+                    {
+                        state_ = State::FAILED;
                     }
+                    i++;
                     break;
-                case Token::COLON:
-                    after_colon_ = true;
-                    value_start_ = &c + 1;
-                    value_size_ = 0;
+                case State::DATA_LF:
+                    if (c == '\n')
+                    {
+                        start_chunk();
+                        i++;
+                    }
+                    else
+                    {
+                        state_ = State::FAILED;
+                    }
                     break;
-                case Token::COMMA:
-                    // Maybe we found a value
-                    if( after_colon_)
+                case State::TRAILER_LINE_START:
+                    // An empty line ends the trailer section and the body
+                    if (c == '\r')
                     {
-                        listener_->on_value(JSONValue(value_start_, value_size_ - 1));
-                        value_start_ = nullptr;
-                        value_size_ = 0;
+                        state_ = State::TRAILER_END_LF;
                     }
-                    else if (state_stack_.back() == State::IN_ARRAY && value_start_ != nullptr)
+                    else if (c == '\n')
                     {
-                        listener_->on_value(JSONValue(value_start_, value_size_ - 1));
-                        value_start_ = &c + 1;
-                        value_size_ = 0;
+                        state_ = State::DONE;
                     }
-
-                    if (state_stack_.back() == State::IN_ARRAY)
+                    else
                     {
-                        listener_->on_array_next_element();
+                        state_ = State::TRAILER;
                     }
-
-                    after_colon_ = false;
+                    i++;
                     break;
-                case Token::NONE:
+                case State::TRAILER:
+                {
+                    // Trailer fields are ignored
+                    const char * lf = static_cast<const char *>(memchr(chunk + i, '\n', size - i));
+                    if (lf)
+                    {
+                        state_ = State::TRAILER_LINE_START;
+                        i = lf - chunk + 1;
+                    }
+                    else
+                    {
+                        i = size;
+                    }
+                    break;
+                }
+                case State::TRAILER_END_LF:
+                    state_ = State::DONE;
+                    if (c == '\n')
+                    {
+                        i++;
+                    }
                     break;
                 default:
                     break;
             }
         }
+    }
 
-        // Return the required point to keep
-        size_t allow_to_remove = value_start_ ? value_start_ - chunk : size;
-
-        return allow_to_remove;
+    void reset()
+    {
+        start_chunk();
     }
 
-    virtual void reset(IJSONListener & listener)
+    /**
+     * @brief True once the last chunk and the trailer section have been decoded
+    */
+    bool done() const
     {
-        listener_ = &listener;
-        state_stack_.clear();
-        after_colon_ = false;
-        value_start_ = nullptr;
-        value_size_ = 0;
+        return state_ == State::DONE;
+    }
 
+    /**
+     * @brief True if the input is not a valid chunked body, no more data is forwarded
+    */
+    bool failed() const
+    {
+        return state_ == State::FAILED;
     }
 
 protected:
 
     enum class State : uint8_t
     {
-        IN_OBJECT,
-        IN_ARRAY,
-        IN_STRING,
+        SIZE,
+        EXTENSION,
+        SIZE_LF,
+        DATA,
+        DATA_CR,
+        DATA_LF,
+        TRAILER_LINE_START,
+        TRAILER,
+        TRAILER_END_LF,
+        DONE,
+        FAILED,
     };
 
-    enum class Token
+    static constexpr size_t MAX_SIZE_DIGITS = 2 * sizeof(size_t) - 1;
+
+    static int hex_value(const char c)
     {
-        OBJECT_START,
-        OBJECT_END,
-        ARRAY_START,
-        ARRAY_END,
-        QUOTE,
-        COLON,
-        COMMA,
-        NONE
-    };
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
 
-    using TokenMapType = std::array<std::pair<Token, char>, static_cast<size_t>(Token::NONE)>;
-    const TokenMapType token_map_ = {
-        std::make_pair(Token::OBJECT_START, '{'),
-        std::make_pair(Token::OBJECT_END, '}'),
-        std::make_pair(Token::ARRAY_START, '['),
-        std::make_pair(Token::ARRAY_END, ']'),
-        std::make_pair(Token::QUOTE, '"'),
-        std::make_pair(Token::COLON, ':'),
-        std::make_pair(Token::COMMA, ',')
-    };
+        return -1;
+    }
 
-    Token get_token(const char c)
+    void start_chunk()
     {
-        for (const auto & pair : token_map_)
+        state_ = State::SIZE;
+        remaining_ = 0;
+        size_digits_ = 0;
+    }
+
+    void end_size_line(const char c)
+    {
+        if (c == '\r')
         {
-            if (pair.second == c)
-            {
-                return pair.first;
-            }
+            state_ = State::SIZE_LF;
+        }
+        else
+        {
+            state_ = (remaining_ == 0) ? State::TRAILER_LINE_START : State::DATA;
         }
-
-        return Token::NONE;
     }
 
-    IJSONListener * listener_;
-    IJSONListener dummy_listener_;
+    ParserType & parser_;
 
     // State variables
-    std::vector<State> state_stack_;
-    bool after_colon_ = false;
-    char const * value_start_ = nullptr;
-    size_t value_size_ = 0;
+    State state_ = State::SIZE;
+    size_t remaining_ = 0;
+    size_t size_digits_ = 0;
 };
 
+#ifdef STREAMJSON_ZLIB
+
 /**
- * @class AutofeedStreamJson
+ * @class GzipDecoder
  *
- * @brief A JSON parser that can be fed with chunks of data and automatically calls the feed method
+ * @brief A zlib based decompression stage that inflates gzip, zlib or raw deflate data into a parser
+ *
+ * Data is inflated directly into the free space of the parser buffer (see AutofeedStreamJson::write_buffer())
+ * and parsed piece by piece, so memory usage is bounded by the zlib window and the parser buffer.
+ * Concatenated gzip members are decoded as a single stream.
 */
-template<size_t CHUNK_SIZE>
-class AutofeedStreamJson : public StreamJson
+template<typename ParserType>
+class GzipDecoder
 {
 public:
-    AutofeedStreamJson()
-    : StreamJson()
+
+    enum class Format
+    {
+        AUTO,   // gzip or zlib header
+        RAW     // raw deflate
+    };
+
+    GzipDecoder(ParserType & parser, Format format = Format::AUTO)
+    : parser_(parser)
+    , window_bits_(format == Format::RAW ? -MAX_WBITS : MAX_WBITS + 32)
     {
+        init();
     }
 
-    AutofeedStreamJson(IJSONListener & listener)
-    : StreamJson(listener)
+    GzipDecoder(const GzipDecoder &) = delete;
+    GzipDecoder & operator=(const GzipDecoder &) = delete;
+
+    ~GzipDecoder()
     {
+        inflateEnd(&stream_);
     }
 
     void feed(const char * chunk, size_t size)
     {
-        if(!failed_)
+        stream_.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(chunk));
+
+        while (!failed_ && size > 0)
         {
-            // Copy new data to the buffer
-            memcpy(buffer_.data() + next_offset_, chunk, size);
+            // zlib counts input with uInt
+            uInt piece = static_cast<uInt>(std::min<size_t>(size, MAX_INPUT_SIZE));
+            stream_.avail_in = piece;
+            size -= piece;
 
-            // Actual size of the buffer
-            size += next_offset_;
+            inflate_input();
+        }
+    }
 
-            // Feed the buffer
-            size_t to_remove = StreamJson::feed(buffer_.data(), size, next_offset_);
+    void reset()
+    {
+        inflateReset(&stream_);
+        done_ = false;
+        failed_ = false;
+    }
 
-            // Remove the processed data
-            memmove(buffer_.data(), buffer_.data() + to_remove, size - to_remove + 1);
-            next_offset_ = size - to_remove;
+    /**
+     * @brief True once the end of the compressed stream has been reached
+    */
+    bool done() const
+    {
+        return done_;
+    }
 
-            if (next_offset_ >= CHUNK_SIZE)
+    /**
+     * @brief True if the input is corrupted or the parser could not take more data
+    */
+    bool failed() const
+    {
+        return failed_;
+    }
+
+protected:
+
+    static constexpr size_t MAX_INPUT_SIZE = 1 << 30;
+
+    void init()
+    {
+        stream_.zalloc = Z_NULL;
+        stream_.zfree = Z_NULL;
+        stream_.opaque = Z_NULL;
+        stream_.next_in = Z_NULL;
+        stream_.avail_in = 0;
+
+        failed_ = inflateInit2(&stream_, window_bits_) != Z_OK;
+    }
+
+    void inflate_input()
+    {
+        bool output_full = false;
+
+        // Keep inflating while there is input or pending output
+        while (!failed_ && (stream_.avail_in > 0 || output_full))
+        {
+            if (done_)
+            {
+                // Concatenated member
+                inflateReset(&stream_);
+                done_ = false;
+            }
+
+            size_t capacity = std::min<size_t>(parser_.write_capacity(), std::numeric_limits<uInt>::max());
+            if (capacity == 0)
             {
                 failed_ = true;
+                break;
             }
-        }
-    };
 
-    void reset(IJSONListener & listener)
-    {
-        StreamJson::reset(listener);
-        next_offset_ = 0;
-        failed_ = false;
+            stream_.next_out = reinterpret_cast<Bytef *>(parser_.write_buffer());
+            stream_.avail_out = static_cast<uInt>(capacity);
+
+            int result = inflate(&stream_, Z_NO_FLUSH);
+
+            size_t produced = capacity - stream_.avail_out;
+            output_full = stream_.avail_out == 0;
+
+            // Parse this piece before inflating the next one
+            parser_.commit(produced);
+
+            if (result == Z_STREAM_END)
+            {
+                done_ = true;
+                output_full = false;
+            }
+            else if (result == Z_BUF_ERROR && produced == 0)
+            {
+                // No progress possible until more input arrives
+                break;
+            }
+            else if (result != Z_OK && result != Z_BUF_ERROR)
+            {
+                failed_ = true;
+            }
+        }
     }
 
-protected:
+    ParserType & parser_;
+    int window_bits_;
 
-    std::array<char, CHUNK_SIZE> buffer_;
-    size_t next_offset_ = 0;
+    // State variables
+    z_stream stream_;
+    bool done_ = false;
     bool failed_ = false;
 };
 
+#endif // STREAMJSON_ZLIB
+
 } // namespace streamjson
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Latency percentiles of JSON logs parsed in two shards, checked against the exact values
+using Latencies = streamjson::QuantileListener<"latency_ms">;
+
+void parse(streamjson::IJSONListener & listener, const std::string & input)
+{
+    constexpr size_t BUFFER_SIZE = 128;
+    streamjson::AutofeedStreamJson<BUFFER_SIZE> chunk_parser(listener);
+
+    constexpr size_t CHUNK_SIZE = 61;
+    feed_chunks(chunk_parser, input, CHUNK_SIZE);
+}
+
+int main(int argc, char* argv[] )
+{
+    constexpr size_t RECORDS = 100000;
+
+    std::string shards[2];
+    std::vector<double> latencies;
+
+    uint64_t state = 1;
+    for (size_t i = 0; i < RECORDS; i++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+        // Long tailed latencies
+        double uniform = static_cast<double>(state >> 11) / static_cast<double>(uint64_t(1) << 53);
+        double latency = std::round(-std::log(1.0 - uniform) * 40.0 * 100.0) / 100.0;
+        latencies.push_back(latency);
+
+        shards[i % 2] += "{\"route\": \"/api\", \"latency_ms\": " + std::to_string(latency) + "}\n";
+    }
+
+    Latencies listeners[2];
+    parse(listeners[0], shards[0]);
+    parse(listeners[1], shards[1]);
+    listeners[0].merge(listeners[1]);
+
+    std::sort(latencies.begin(), latencies.end());
+
+    bool ok = listeners[0].sketch().count() == RECORDS && listeners[0].sketch().size() < 1000;
+
+    for (double q : {0.5, 0.9, 0.99})
+    {
+        double estimate = listeners[0].quantile(q);
+
+        // Rank of the estimate in the exact data
+        double rank = static_cast<double>(std::lower_bound(latencies.begin(), latencies.end(), estimate) - latencies.begin()) / RECORDS;
+
+        std::cout << "p" << q * 100 << ": " << estimate << " (exact " << latencies[static_cast<size_t>(q * RECORDS)] << ")" << std::endl;
+
+        ok = ok && std::abs(rank - q) < 0.01;
+    }
+
+    return ok ? 0 : 1;
+}
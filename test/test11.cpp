@@ -0,0 +1,168 @@
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+// Requests per minute over a live feed with out of order records
+struct Result
+{
+    int64_t start;
+    int64_t end;
+    size_t records;
+    double sum;
+};
+
+std::vector<Result> run(const std::string & input, int64_t size, int64_t slide, int64_t lateness, size_t & late, size_t & max_open)
+{
+    std::vector<Result> results;
+
+    streamjson::WindowListener windows("ts", "bytes", size, slide, lateness, [&](int64_t start, int64_t end, size_t records, const streamjson::Aggregate & bytes)
+    {
+        results.push_back(Result{start, end, records, bytes.sum});
+    });
+
+    constexpr size_t BUFFER_SIZE = 128;
+    streamjson::AutofeedStreamJson<BUFFER_SIZE> chunk_parser(windows);
+
+    max_open = 0;
+    constexpr size_t CHUNK_SIZE = 23;
+    const char * ptr = input.data();
+    while (ptr < (input.data() + input.size()))
+    {
+        size_t actual_size = std::min(CHUNK_SIZE, input.size() - (ptr - input.data()));
+        chunk_parser.feed(ptr, actual_size);
+        ptr += actual_size;
+        max_open = std::max(max_open, windows.open_windows());
+    }
+
+    windows.flush();
+    late = windows.late();
+
+    return results;
+}
+
+int main(int argc, char* argv[] )
+{
+    constexpr int64_t MINUTE = 60000;
+
+    // 2024-03-01T12:00:00Z
+    constexpr int64_t BASE = 1709294400000;
+
+    int64_t epoch;
+    bool ok = streamjson::detail::parse_timestamp("2024-03-01T12:00:00.123+01:00", epoch) && epoch == (BASE - 3600000 + 123) * 1000000;
+    ok = ok && streamjson::detail::parse_timestamp("1969-12-31 23:59:59Z", epoch) && epoch == -1000000000;
+    ok = ok && !streamjson::detail::parse_timestamp("2024-13-01T00:00:00Z", epoch);
+
+    std::string feed =
+        "{\"ts\": \"2024-03-01T12:00:05Z\", \"bytes\": 100}\n"
+        "{\"ts\": 1709294410000, \"bytes\": 200}\n"                       // 12:00:10
+        "{\"ts\": \"2024-03-01T12:01:02.500Z\", \"bytes\": 300}\n"
+        "{\"ts\": \"2024-03-01T12:00:55Z\", \"bytes\": 400}\n"            // out of order, within lateness
+        "{\"ts\": \"2024-03-01T13:02:40+01:00\", \"bytes\": 500}\n"       // 12:02:40, closes [12:00, 12:01)
+        "{\"ts\": \"2024-03-01T12:00:59Z\", \"bytes\": 600}\n"            // late
+        "{\"ts\": \"2024-03-01T12:02:50Z\"}\n";
+
+    size_t late, max_open;
+    std::vector<Result> tumbling = run(feed, MINUTE, MINUTE, 30000, late, max_open);
+
+    for (const auto & result : tumbling)
+    {
+        std::cout << "[" << (result.start - BASE) / 1000 << "s, " << (result.end - BASE) / 1000 << "s) records: " << result.records << " bytes: " << result.sum << std::endl;
+    }
+
+    ok = ok && late == 1 && tumbling.size() == 3;
+    ok = ok && tumbling[0].start == BASE && tumbling[0].records == 3 && tumbling[0].sum == 700;
+    ok = ok && tumbling[1].records == 1 && tumbling[1].sum == 300;
+    ok = ok && tumbling[2].records == 2 && tumbling[2].sum == 500;
+
+    // Empty windows and slides are clamped to one millisecond instead of dividing by zero
+    std::vector<Result> clamped = run(feed, 0, 0, -1, late, max_open);
+
+    ok = ok && late == 2 && clamped.size() == 5 && max_open <= 1;
+    for (const auto & result : clamped)
+    {
+        ok = ok && result.end == result.start + 1 && result.records == 1;
+    }
+
+    // One minute windows every two minutes: records in the gaps are not late
+    std::vector<Result> hopping;
+    streamjson::WindowListener gaps("ts", "bytes", MINUTE, 2 * MINUTE, 0, [&](int64_t start, int64_t end, size_t records, const streamjson::Aggregate & bytes)
+    {
+        hopping.push_back(Result{start, end, records, bytes.sum});
+    });
+
+    std::string gap_feed =
+        "{\"ts\": \"2024-03-01T12:00:30Z\", \"bytes\": 1}\n"
+        "{\"ts\": \"2024-03-01T12:01:30Z\", \"bytes\": 2}\n"         // gap
+        "{\"ts\": \"2024-03-01T12:02:30Z\", \"bytes\": 4}\n"
+        "{\"ts\": \"2024-03-01T12:00:40Z\", \"bytes\": 8}\n"         // late
+        "{\"ts\": \"2024-03-01T12:03:10Z\", \"bytes\": 16}\n";       // gap
+
+    streamjson::AutofeedStreamJson<128> gap_parser(gaps);
+    gap_parser.feed(gap_feed.data(), gap_feed.size());
+    gaps.flush();
+
+    std::cout << "gaps: " << gaps.gaps() << " late: " << gaps.late() << " windows: " << hopping.size() << std::endl;
+
+    ok = ok && gaps.gaps() == 2 && gaps.late() == 1 && hopping.size() == 2;
+    ok = ok && hopping[0].start == BASE && hopping[0].sum == 1 && hopping[1].start == BASE + 2 * MINUTE && hopping[1].sum == 4;
+
+    // Extreme timestamps: windows whose bounds do not fit in int64_t hold nothing, the others still work
+    std::vector<Result> extremes;
+    streamjson::WindowListener extreme("ts", "bytes", 1, 1, 5, [&](int64_t start, int64_t end, size_t records, const streamjson::Aggregate & bytes)
+    {
+        extremes.push_back(Result{start, end, records, bytes.sum});
+    });
+
+    std::string extreme_feed =
+        "{\"ts\": -9223372036854775808, \"bytes\": 1}\n"
+        "{\"ts\": 9223372036854775807, \"bytes\": 2}\n"
+        "{\"ts\": -9223372036854775807, \"bytes\": 4}\n";
+
+    streamjson::AutofeedStreamJson<128> extreme_parser(extreme);
+    extreme_parser.feed(extreme_feed.data(), extreme_feed.size());
+    extreme.flush();
+
+    ok = ok && extreme.gaps() == 1 && extreme.late() == 0 && extremes.size() == 2;
+    ok = ok && extremes[0].start == std::numeric_limits<int64_t>::min() && extremes[0].sum == 1 && extremes[1].sum == 4;
+
+    std::string minute_feed = "{\"ts\": -9223372036854775808} {\"ts\": 9223372036854775807} {\"ts\": " + std::to_string(BASE) + "}\n";
+    streamjson::WindowListener minutes("ts", "bytes", MINUTE, MINUTE, 0, [&](int64_t start, int64_t end, size_t records, const streamjson::Aggregate & bytes)
+    {
+        extremes.push_back(Result{start, end, records, bytes.sum});
+    });
+
+    streamjson::AutofeedStreamJson<128> minute_parser(minutes);
+    minute_parser.feed(minute_feed.data(), minute_feed.size());
+    minutes.flush();
+
+    std::cout << "extreme gaps: " << extreme.gaps() << " " << minutes.gaps() << std::endl;
+    ok = ok && minutes.gaps() == 2 && minutes.late() == 0 && extremes.size() == 3 && extremes[2].start == BASE;
+
+    // The listener takes a new stream after flush(), reset() also drops the counters
+    minute_parser.feed(minute_feed.data(), minute_feed.size());
+    minutes.flush();
+    ok = ok && minutes.late() == 0 && minutes.gaps() == 4 && extremes.size() == 4 && extremes[3].start == BASE;
+
+    minutes.reset();
+    ok = ok && minutes.gaps() == 0 && minutes.watermark() == std::numeric_limits<int64_t>::min();
+
+    // Sliding two minute windows every minute, many records over a day
+    std::string day;
+    for (int64_t t = 0; t < 24 * 60 * MINUTE; t += 1000)
+    {
+        day += "{\"ts\": " + std::to_string(BASE + t) + ", \"bytes\": 1}\n";
+    }
+
+    std::vector<Result> sliding = run(day, 2 * MINUTE, MINUTE, 5000, late, max_open);
+
+    ok = ok && late == 0 && max_open <= 3 && sliding.size() == 24 * 60 + 1;
+    for (size_t i = 1; ok && i + 1 < sliding.size(); i++)
+    {
+        ok = sliding[i].records == 120 && sliding[i].start == sliding[i - 1].start + MINUTE;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+// ISO 8601 timestamps decoded from raw values, checked against timegm and timed against strptime
+int64_t reference(const std::string & text)
+{
+    std::tm tm = {};
+    strptime(text.c_str(), "%Y-%m-%dT%H:%M:%S", &tm);
+    return static_cast<int64_t>(timegm(&tm));
+}
+
+int main(int argc, char* argv[] )
+{
+    std::vector<std::string> raws;
+
+    uint64_t state = 7;
+    for (size_t i = 0; i < 200000; i++)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+        std::time_t seconds = static_cast<std::time_t>((state >> 33) % 4102444800ULL);
+        std::tm tm;
+        gmtime_r(&seconds, &tm);
+
+        char buffer[64];
+        size_t size = std::strftime(buffer, sizeof(buffer), "\"%Y-%m-%dT%H:%M:%S", &tm);
+        raws.push_back(std::string(buffer, size) + "." + std::to_string(i % 1000) + "Z\"");
+    }
+
+    bool ok = true;
+
+    // Fixed layout against the C library
+    for (const auto & raw : raws)
+    {
+        int64_t nanoseconds;
+        ok = ok && streamjson::JSONValue::timestamp(raw, nanoseconds) && nanoseconds / 1000000000 == reference(raw.substr(1));
+    }
+
+    // Unusual layouts go through the general parser
+    int64_t nanoseconds;
+    ok = ok && streamjson::JSONValue::timestamp("\"2024-03-01T12:00:00.5+02:00\"", nanoseconds) && nanoseconds == 1709287200500000000;
+    ok = ok && streamjson::JSONValue::timestamp("\"2024-03-01t12:00:00z\"", nanoseconds) && nanoseconds == 1709294400000000000;
+    ok = ok && streamjson::JSONValue::timestamp("\"2024-03-01\"", nanoseconds) && nanoseconds == 1709251200000000000;
+    ok = ok && !streamjson::JSONValue::timestamp("\"2024-03-01T12:00:00.Z\"", nanoseconds);
+    ok = ok && !streamjson::JSONValue::timestamp("\"2024-03-01T12:0a:00Z\"", nanoseconds);
+    ok = ok && !streamjson::JSONValue::timestamp("\"2024-03-01T24:00:00Z\"", nanoseconds);
+    ok = ok && !streamjson::JSONValue::timestamp("1709294400", nanoseconds);
+
+    streamjson::JSONValue value(std::string_view("\"1999-12-31T23:59:59.999999999Z\""));
+    ok = ok && value.timestamp(nanoseconds) && nanoseconds == 946684799999999999;
+
+    // Timing
+    auto start = std::chrono::steady_clock::now();
+    uint64_t checksum = 0;
+    for (const auto & raw : raws)
+    {
+        streamjson::JSONValue::timestamp(raw, nanoseconds);
+        checksum += static_cast<uint64_t>(nanoseconds);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (const auto & raw : raws)
+    {
+        checksum -= static_cast<uint64_t>(reference(raw.substr(1)) * 1000000000);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "JSONValue::timestamp: " << std::chrono::duration<double, std::nano>(middle - start).count() / raws.size() << " ns, "
+        << "strptime + timegm: " << std::chrono::duration<double, std::nano>(end - middle).count() / raws.size() << " ns "
+        << "(" << checksum << ")" << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Base64 payloads decoded from raw values and from the deltas of a string still being received
+std::string encode(const std::string & bytes)
+{
+    const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+
+    for (size_t i = 0; i < bytes.size(); i += 3)
+    {
+        uint32_t quad = static_cast<unsigned char>(bytes[i]) << 16;
+        quad |= (i + 1 < bytes.size()) ? static_cast<unsigned char>(bytes[i + 1]) << 8 : 0;
+        quad |= (i + 2 < bytes.size()) ? static_cast<unsigned char>(bytes[i + 2]) : 0;
+
+        result += alphabet[(quad >> 18) & 63];
+        result += alphabet[(quad >> 12) & 63];
+        result += (i + 1 < bytes.size()) ? alphabet[(quad >> 6) & 63] : '=';
+        result += (i + 2 < bytes.size()) ? alphabet[quad & 63] : '=';
+    }
+
+    return result;
+}
+
+struct PayloadListener : public streamjson::JSONListener
+{
+    void on_partial_value(const std::string_view & delta) override {
+        if (path() == "payload")
+        {
+            size_t offset = decoded.size();
+            decoded.resize(offset + streamjson::Base64Decoder::max_decoded_size(delta.size()));
+            decoded.resize(offset + decoder.decode(delta, decoded.data() + offset));
+        }
+    }
+
+    void on_raw_value(const std::string_view & raw) override {
+        if (path() == "payload")
+        {
+            // Whatever was not reported as a delta, then the tail
+            std::string_view rest = raw.substr(1 + decoder.consumed(), raw.size() - 2 - decoder.consumed());
+            size_t offset = decoded.size();
+            decoded.resize(offset + streamjson::Base64Decoder::max_decoded_size(rest.size()) + 3);
+            offset += decoder.decode(rest, decoded.data() + offset);
+            offset += decoder.finish(decoded.data() + offset);
+            decoded.resize(offset);
+        }
+
+        key_.clear();
+    }
+
+    streamjson::Base64Decoder decoder;
+    std::string decoded;
+};
+
+int main(int argc, char* argv[] )
+{
+    bool ok = true;
+
+    std::string bytes;
+    for (size_t i = 0; i < 10000; i++)
+    {
+        bytes += static_cast<char>((i * 131) ^ (i >> 3));
+    }
+
+    // Every tail length, from the raw span and from a JSONValue
+    for (size_t size = 0; size < 40; size++)
+    {
+        std::string expected = bytes.substr(0, size);
+        std::string raw = "\"" + encode(expected) + "\"";
+
+        std::vector<char> out(streamjson::Base64Decoder::max_decoded_size(raw.size()));
+        size_t decoded = streamjson::JSONValue::base64(raw, out.data());
+        ok = ok && decoded == size && std::string(out.data(), decoded) == expected;
+
+        streamjson::JSONValue value(raw);
+        ok = ok && value.base64(out.data()) == size && std::string(out.data(), size) == expected;
+    }
+
+    // Unpadded, escaped slash, invalid
+    std::vector<char> out(64);
+    ok = ok && streamjson::JSONValue::base64("\"TWE\"", out.data()) == 2 && std::string(out.data(), 2) == "Ma";
+    ok = ok && streamjson::JSONValue::base64("\"\\/w==\"", out.data()) == 1 && out[0] == '\xff';
+    ok = ok && streamjson::JSONValue::base64("\"TW=E\"", out.data()) == std::string::npos;
+    ok = ok && streamjson::JSONValue::base64("\"T===\"", out.data()) == std::string::npos;
+    ok = ok && streamjson::JSONValue::base64("\"TQ==TQ==\"", out.data()) == std::string::npos;
+    ok = ok && streamjson::JSONValue::base64("\"TW!u\"", out.data()) == std::string::npos;
+
+    // Large payload streamed in small chunks
+    std::string input = "{\"id\": 1, \"payload\": \"" + encode(bytes) + "\", \"size\": 10000}";
+
+    PayloadListener listener;
+    streamjson::AutofeedStreamJson<16384> chunk_parser(listener);
+
+    constexpr size_t CHUNK_SIZE = 333;
+    feed_chunks(chunk_parser, input, CHUNK_SIZE);
+
+    std::cout << "decoded " << listener.decoded.size() << " bytes" << std::endl;
+
+    ok = ok && !listener.decoder.failed() && listener.decoded == bytes;
+
+    return ok ? 0 : 1;
+}
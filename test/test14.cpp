@@ -0,0 +1,167 @@
+#include <iostream>
+#include <string>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// MessagePack decoded through the same listeners as JSON, events compared with the JSON parser
+
+// Minimal encoder for the test input
+struct Encoder
+{
+    void header(unsigned char fix, unsigned char type, size_t size, size_t limit)
+    {
+        if (size < limit)
+        {
+            bytes += static_cast<char>(fix | size);
+        }
+        else
+        {
+            bytes += static_cast<char>(type);
+            bytes += static_cast<char>(size >> 8);
+            bytes += static_cast<char>(size);
+        }
+    }
+
+    Encoder & map(size_t size) { header(0x80, 0xde, size, 16); return *this; }
+    Encoder & array(size_t size) { header(0x90, 0xdc, size, 16); return *this; }
+    Encoder & str(const std::string & string) { header(0xa0, 0xda, string.size(), 32); bytes += string; return *this; }
+    Encoder & nil() { bytes += '\xc0'; return *this; }
+    Encoder & boolean(bool value) { bytes += value ? '\xc3' : '\xc2'; return *this; }
+
+    Encoder & integer(int64_t value)
+    {
+        if (value >= 0 && value < 128)
+        {
+            bytes += static_cast<char>(value);
+        }
+        else
+        {
+            bytes += '\xd3';
+            for (int shift = 56; shift >= 0; shift -= 8)
+            {
+                bytes += static_cast<char>(value >> shift);
+            }
+        }
+        return *this;
+    }
+
+    Encoder & floating(double value)
+    {
+        bytes += '\xcb';
+        uint64_t bits = std::bit_cast<uint64_t>(value);
+        for (int shift = 56; shift >= 0; shift -= 8)
+        {
+            bytes += static_cast<char>(bits >> shift);
+        }
+        return *this;
+    }
+
+    std::string bytes;
+};
+
+int main(int argc, char* argv[] )
+{
+    std::string json = R"({"a":[{"x":1},{"y":"s"},[],[1,[2,3]],{}],"b":{},"c":null,"d":true,"e":-1.5})"
+        R"( [1,"k",{"z":-200}] {"q":[]})";
+
+    std::string text(40, 'x');
+
+    Encoder encoder;
+    encoder.map(5)
+        .str("a").array(5)
+            .map(1).str("x").integer(1)
+            .map(1).str("y").str("s")
+            .array(0)
+            .array(2).integer(1).array(2).integer(2).integer(3)
+            .map(0)
+        .str("b").map(0)
+        .str("c").nil()
+        .str("d").boolean(true)
+        .str("e").floating(-1.5);
+    encoder.array(3).integer(1).str("k").map(1).str("z").integer(-200);
+    encoder.map(1).str("q").array(0);
+
+    TraceListener expected;
+    streamjson::AutofeedStreamJson<256> json_parser(expected);
+    json_parser.feed(json.data(), json.size());
+
+    bool ok = true;
+
+    // Any split of the input
+    for (size_t chunk_size : {1, 2, 3, 5, 8, 13, 1000})
+    {
+        TraceListener actual;
+        streamjson::MessagePackStreamJson parser(actual);
+
+        feed_chunks(parser, encoder.bytes, chunk_size);
+
+        if (parser.failed() || parser.documents() != 3 || actual.trace != expected.trace)
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << actual.trace << std::endl;
+            ok = false;
+        }
+    }
+
+    // Subscriptions work unchanged
+    Encoder logs;
+    for (int i = 0; i < 100; i++)
+    {
+        logs.map(3).str("service").str(i % 2 ? "api" : "auth").str("latency").integer(i).str("message").str(text);
+    }
+
+    streamjson::AggregateListener<"latency"> latency;
+    std::string services;
+    streamjson::FilterListener<"service"> service_filter([&](const std::string_view & key, const streamjson::JSONValue & value, const std::vector<size_t> & indexes)
+    {
+        services += value.string[0];
+    });
+
+    streamjson::MultiListener listener;
+    listener.add_listener(latency);
+    listener.add_listener(service_filter);
+
+    streamjson::MessagePackStreamJson parser(listener);
+    feed_chunks(parser, logs.bytes, 7);
+
+    std::cout << "latency sum: " << latency.aggregate().sum << " services: " << services.substr(0, 10) << std::endl;
+
+    ok = ok && latency.aggregate().count == 100 && latency.aggregate().sum == 4950 && services.size() == 100 && services.substr(0, 2) == "aa";
+
+    // Streams ending in an item whose multi-byte header is completed by the last byte:
+    // {"a":200} (uint 8), {"a":-1000} (int 16), {"a":""} (str 8)
+    std::pair<std::string, std::string> headers[] = {
+        {R"({"a":200})", std::string("\x81\xa1\x61\xcc\xc8", 5)},
+        {R"({"a":-1000})", std::string("\x81\xa1\x61\xd1\xfc\x18", 6)},
+        {R"({"a":""})", std::string("\x81\xa1\x61\xd9\x00", 5)}
+    };
+
+    for (const auto & [header_json, header] : headers)
+    {
+        TraceListener header_expected;
+        streamjson::AutofeedStreamJson<64> header_parser(header_expected);
+        header_parser.feed(header_json.data(), header_json.size());
+
+        for (size_t chunk_size : {1, 4})
+        {
+            TraceListener actual;
+            streamjson::MessagePackStreamJson parser(actual);
+            feed_chunks(parser, header, chunk_size);
+
+            if (parser.failed() || parser.documents() != 1 || actual.trace != header_expected.trace)
+            {
+                std::cout << header_json << ", chunk size " << chunk_size << ": " << actual.trace << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    // Reserved type
+    TraceListener invalid;
+    streamjson::MessagePackStreamJson invalid_parser(invalid);
+    invalid_parser.feed("\x91\xc1", 2);
+    ok = ok && invalid_parser.failed();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace std::string_literals;
+
+// CBOR decoded through the same listeners as JSON, events compared with the JSON parser and parse time with the same data as JSON
+
+// Minimal encoder for the test input
+struct Encoder
+{
+    Encoder & head(unsigned char major, uint64_t argument)
+    {
+        if (argument < 24)
+        {
+            bytes += static_cast<char>((major << 5) | argument);
+        }
+        else
+        {
+            bytes += static_cast<char>((major << 5) | 27);
+            for (int shift = 56; shift >= 0; shift -= 8)
+            {
+                bytes += static_cast<char>(argument >> shift);
+            }
+        }
+        return *this;
+    }
+
+    Encoder & map(size_t size) { return head(5, size); }
+    Encoder & array(size_t size) { return head(4, size); }
+    Encoder & indefinite_map() { bytes += '\xbf'; return *this; }
+    Encoder & indefinite_array() { bytes += '\x9f'; return *this; }
+    Encoder & end() { bytes += '\xff'; return *this; }
+    Encoder & str(const std::string & string) { head(3, string.size()); bytes += string; return *this; }
+    Encoder & integer(int64_t value) { return value >= 0 ? head(0, value) : head(1, -1 - value); }
+    Encoder & raw(const std::string & raw) { bytes += raw; return *this; }
+
+    std::string bytes;
+};
+
+int main(int argc, char* argv[] )
+{
+    std::string json = R"({"a":[{"x":1},{"y":"stream"},[],[1,[2,3]],{}],"b":{},"c":null,"d":true,"e":-1.5})"
+        R"( [1,"k",{"z":-200}] {"q":[],"h":1.5,"t":0})";
+
+    Encoder encoder;
+    encoder.indefinite_map()
+        .str("a").array(5)
+            .map(1).str("x").integer(1)
+            .map(1).raw("\x61y").raw("\x7f\x63str\x63\x65\x61m\xff")     // indefinite length text
+            .indefinite_array().end()
+            .array(2).integer(1).indefinite_array().integer(2).integer(3).end()
+            .map(0)
+        .str("b").indefinite_map().end()
+        .str("c").raw("\xf6")
+        .str("d").raw("\xf5")
+        .str("e").raw("\xfb\xbf\xf8\x00\x00\x00\x00\x00\x00"s)
+        .end();
+    encoder.array(3).integer(1).str("k").map(1).str("z").integer(-200);
+    encoder.map(3).str("q").array(0).str("h").raw("\xf9\x3e\x00"s).str("t").raw("\xc1\x00"s);      // half float, tagged epoch
+
+    TraceListener expected;
+    streamjson::AutofeedStreamJson<256> json_parser(expected);
+    json_parser.feed(json.data(), json.size());
+
+    bool ok = true;
+
+    // Any split of the input
+    for (size_t chunk_size : {1, 2, 3, 5, 8, 13, 1000})
+    {
+        TraceListener actual;
+        streamjson::CborStreamJson parser(actual);
+
+        feed_chunks(parser, encoder.bytes, chunk_size);
+
+        if (parser.failed() || parser.documents() != 3 || actual.trace != expected.trace)
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << actual.trace << std::endl;
+            ok = false;
+        }
+    }
+
+    // Streams ending in an item whose argument is completed by the last byte:
+    // {"a":200} (1 byte), {"a":-1000} (2 bytes), {"a":100000} (4 bytes)
+    std::pair<std::string, std::string> arguments[] = {
+        {R"({"a":200})", "\xa1\x61\x61\x18\xc8"s},
+        {R"({"a":-1000})", "\xa1\x61\x61\x39\x03\xe7"s},
+        {R"({"a":100000})", "\xa1\x61\x61\x1a\x00\x01\x86\xa0"s}
+    };
+
+    for (const auto & [argument_json, argument] : arguments)
+    {
+        TraceListener argument_expected;
+        streamjson::AutofeedStreamJson<64> argument_parser(argument_expected);
+        argument_parser.feed(argument_json.data(), argument_json.size());
+
+        TraceListener actual;
+        streamjson::CborStreamJson parser(actual);
+        feed_chunks(parser, argument, 1);
+
+        if (parser.failed() || parser.documents() != 1 || actual.trace != argument_expected.trace)
+        {
+            std::cout << argument_json << ": " << actual.trace << std::endl;
+            ok = false;
+        }
+    }
+
+    // Unbalanced break, reserved argument
+    TraceListener invalid;
+    streamjson::CborStreamJson invalid_parser(invalid);
+    invalid_parser.feed("\x82\x01\xff", 3);
+    ok = ok && invalid_parser.failed();
+    invalid_parser.reset(invalid);
+    invalid_parser.feed("\x1c", 1);
+    ok = ok && invalid_parser.failed();
+
+    // String lengths that overflow size_t with the header, or that exceed MAX_ITEM_SIZE
+    invalid_parser.reset(invalid);
+    invalid_parser.feed("\x7b\xff\xff\xff\xff\xff\xff\xff\xf8\x61\x62", 11);
+    ok = ok && invalid_parser.failed();
+    invalid_parser.reset(invalid);
+    invalid_parser.feed("\x5a\x40\x00\x00\x00", 5);
+    ok = ok && invalid_parser.failed();
+
+    // The same records as CBOR and as JSON through the same filter
+    Encoder logs;
+    std::string logs_json;
+    for (int i = 0; i < 100000; i++)
+    {
+        logs.map(3).str("service").str(i % 2 ? "api" : "auth").str("latency").integer(i % 1000).str("tags").array(2).str("edge").str("v2");
+        logs_json += "{\"service\": \"" + std::string(i % 2 ? "api" : "auth") + "\", \"latency\": " + std::to_string(i % 1000) + ", \"tags\": [\"edge\", \"v2\"]}\n";
+    }
+
+    streamjson::AggregateListener<"latency"> cbor_latency;
+    streamjson::AggregateListener<"latency"> json_latency;
+
+    auto start = std::chrono::steady_clock::now();
+    streamjson::CborStreamJson cbor_parser(cbor_latency);
+    feed_chunks(cbor_parser, logs.bytes, 4096);
+    auto middle = std::chrono::steady_clock::now();
+    streamjson::AutofeedStreamJson<4096> logs_parser(json_latency);
+    feed_chunks(logs_parser, logs_json, 4096);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "CBOR: " << logs.bytes.size() << " bytes in " << std::chrono::duration<double, std::milli>(middle - start).count() << " ms, "
+        << "JSON: " << logs_json.size() << " bytes in " << std::chrono::duration<double, std::milli>(end - middle).count() << " ms" << std::endl;
+
+    ok = ok && cbor_latency.aggregate().sum == json_latency.aggregate().sum && cbor_latency.aggregate().count == 100000;
+
+    return ok ? 0 : 1;
+}
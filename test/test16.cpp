@@ -0,0 +1,140 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// JSON transcoded to CBOR and MessagePack in one pass, decoded back and compared through canonical digests
+void parse(streamjson::IJSONListener & listener, const std::string & input)
+{
+    constexpr size_t BUFFER_SIZE = 4096;
+    streamjson::AutofeedStreamJson<BUFFER_SIZE> chunk_parser(listener);
+
+    constexpr size_t CHUNK_SIZE = 1000;
+    feed_chunks(chunk_parser, input, CHUNK_SIZE);
+}
+
+template<typename ParserType>
+std::vector<uint64_t> decode(const std::string & input)
+{
+    std::vector<uint64_t> digests;
+    streamjson::CanonicalHashListener hash([&](uint64_t digest)
+    {
+        digests.push_back(digest);
+    });
+
+    ParserType parser(hash);
+    feed_chunks(parser, input, 777);
+
+    return parser.failed() ? std::vector<uint64_t>() : digests;
+}
+
+int main(int argc, char* argv[] )
+{
+    std::string input =
+        R"({"name": "café \"quoted\"", "id": 12345678901, "neg": -40, "ratio": 0.1, "half": 0.5, "ok": true, "none": null})" "\n"
+        R"([1, [], {}, [[-1, 2.25], {"deep": {"er": ["x", "😀"]}}]])" "\n";
+
+    std::string text(300, 'y');
+    for (int i = 0; i < 20000; i++)
+    {
+        input += "{\"id\": " + std::to_string(i) + ", \"user\": {\"name\": \"user" + std::to_string(i % 97) + "\", \"scores\": [" +
+            std::to_string(i % 13) + ", " + std::to_string(i * 0.25) + "]}, \"text\": \"" + (i % 100 == 0 ? text : "short") + "\", \"flag\": false}\n";
+    }
+
+    std::vector<uint64_t> expected;
+    streamjson::CanonicalHashListener hash([&](uint64_t digest)
+    {
+        expected.push_back(digest);
+    });
+    parse(hash, input);
+
+    std::string cbor;
+    streamjson::CborWriter<4096> cbor_writer([&](const char * data, size_t size)
+    {
+        cbor.append(data, size);
+    });
+
+    std::string msgpack;
+    streamjson::MessagePackWriter msgpack_writer([&](const char * data, size_t size)
+    {
+        msgpack.append(data, size);
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    parse(cbor_writer, input);
+    cbor_writer.flush();
+    auto middle = std::chrono::steady_clock::now();
+    parse(msgpack_writer, input);
+    auto end = std::chrono::steady_clock::now();
+
+    double megabytes = input.size() / 1e6;
+    std::cout << "JSON " << input.size() << " bytes -> CBOR " << cbor.size() << " bytes (" << megabytes / std::chrono::duration<double>(middle - start).count() << " MB/s), "
+        << "MessagePack " << msgpack.size() << " bytes (" << megabytes / std::chrono::duration<double>(end - middle).count() << " MB/s)" << std::endl;
+
+    bool ok = expected.size() == 20002;
+    ok = ok && decode<streamjson::CborStreamJson>(cbor) == expected;
+    ok = ok && decode<streamjson::MessagePackStreamJson>(msgpack) == expected;
+
+    // Binary back to binary keeps the strings
+    std::string again;
+    streamjson::MessagePackWriter round_trip([&](const char * data, size_t size)
+    {
+        again.append(data, size);
+    });
+    streamjson::CborStreamJson cbor_parser(round_trip);
+    cbor_parser.feed(cbor.data(), cbor.size());
+    ok = ok && again == msgpack;
+
+    // Top-level strings are documents of their own, unbalanced ends are ignored
+    std::string scalars;
+    streamjson::MessagePackWriter scalar_writer([&](const char * data, size_t size)
+    {
+        scalars.append(data, size);
+    });
+    scalar_writer.on_object_end();
+    parse(scalar_writer, "\"abc\"\n{\"a\": [\"b\"]}\n\"x\"\n");
+    scalar_writer.on_array_end();
+
+    TraceListener trace;
+    streamjson::MessagePackStreamJson scalar_parser(trace);
+    scalar_parser.feed(scalars.data(), scalars.size());
+    std::cout << trace.trace << std::endl;
+    ok = ok && !scalar_parser.failed() && trace.trace == "V(abc)|{K(a)[V(b)]}|V(x)|";
+
+    // Literals are classified as JSONValue does
+    std::string literals = "[true, True, TRUE, false, False, FALSE, null, None, NULL]\n";
+    TraceListener literals_expected;
+    parse(literals_expected, literals);
+
+    std::string literals_cbor;
+    streamjson::CborWriter<64> literals_cbor_writer([&](const char * data, size_t size)
+    {
+        literals_cbor.append(data, size);
+    });
+    parse(literals_cbor_writer, literals);
+    literals_cbor_writer.flush();
+
+    std::string literals_msgpack;
+    streamjson::MessagePackWriter literals_msgpack_writer([&](const char * data, size_t size)
+    {
+        literals_msgpack.append(data, size);
+    });
+    parse(literals_msgpack_writer, literals);
+
+    TraceListener literals_from_cbor;
+    streamjson::CborStreamJson literals_cbor_parser(literals_from_cbor);
+    literals_cbor_parser.feed(literals_cbor.data(), literals_cbor.size());
+
+    TraceListener literals_from_msgpack;
+    streamjson::MessagePackStreamJson literals_msgpack_parser(literals_from_msgpack);
+    literals_msgpack_parser.feed(literals_msgpack.data(), literals_msgpack.size());
+
+    std::cout << literals_from_cbor.trace << std::endl << literals_from_msgpack.trace << std::endl;
+    ok = ok && literals_from_cbor.trace == literals_expected.trace && literals_from_msgpack.trace == literals_expected.trace;
+
+    return ok ? 0 : 1;
+}
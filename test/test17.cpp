@@ -0,0 +1,68 @@
+#include <iostream>
+#include <string>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// JSONC configuration parsed in lenient mode, compared with the same document without comments
+std::string parse(const std::string & input, size_t chunk_size, bool lenient)
+{
+    TraceListener listener;
+    streamjson::AutofeedStreamJson<64> chunk_parser(listener);
+    chunk_parser.set_lenient(lenient);
+
+    feed_chunks(chunk_parser, input, chunk_size);
+
+    return chunk_parser.failed() ? "FAILED" : listener.trace;
+}
+
+int main(int argc, char* argv[] )
+{
+    std::string long_comment(500, '*');
+
+    std::string jsonc = R"(// Service configuration
+{
+    "name": "gateway", // inline comment after a string
+    "port": 8080 /* comment right after a number */,
+    "url": "http://example.com/a//b", /* slashes in strings are data */
+    "retries": /* before a value */ 3,
+    "hosts": [
+        "a", // first
+        /* between */ "b",
+        10//
+        ,
+        { "weight": 2, }, /)" + long_comment + R"(/
+    ],
+    "empty": [ /* nothing */ ],
+    "nested": [[1, 2,], [],],
+    "flag": true,
+}
+/* trailing */ {"second": null}
+)";
+
+    std::string json = R"({"name": "gateway", "port": 8080, "url": "http://example.com/a//b", "retries": 3,
+        "hosts": ["a", "b", 10, {"weight": 2}], "empty": [], "nested": [[1, 2], []], "flag": true}
+        {"second": null})";
+
+    std::string expected = parse(json, 1000, false);
+
+    bool ok = true;
+
+    for (size_t chunk_size : {1, 2, 3, 7, 16, 1000})
+    {
+        std::string actual = parse(jsonc, chunk_size, true);
+        if (actual != expected)
+        {
+            std::cout << chunk_size << ": " << actual << std::endl;
+            ok = false;
+        }
+    }
+
+    // Strict mode is unchanged
+    ok = ok && parse(json, 5, true) == expected && parse(json, 5, false) == expected;
+
+    std::cout << parse(jsonc, 7, true) << std::endl;
+
+    return ok ? 0 : 1;
+}
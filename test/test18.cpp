@@ -0,0 +1,69 @@
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include <streamjson.hpp>
+
+// Configuration parsed at compile time
+constexpr auto & config = streamjson::static_json<R"({
+    "name": "sensor-gateway",
+    "port": 8080,
+    "ratio": -0.25,
+    "scale": 1.5e3,
+    "debug": false,
+    "proxy": null,
+    "owners": [{"name": "ana", "age": 31}, {"name": "bo", "age": 26}],
+    "empty": {},
+    "escaped": "say \"hi\""
+})">;
+
+static_assert(config.root().kind == streamjson::StaticNode::Kind::OBJECT);
+static_assert(config.find("name")->string() == "sensor-gateway");
+static_assert(config.find("port")->type == streamjson::JSONValue::Type::INTEGER && config.find("port")->integer == 8080);
+static_assert(config.find("ratio")->floating == -0.25);
+static_assert(config.find("scale")->floating == 1500.0);
+static_assert(config.find("debug")->type == streamjson::JSONValue::Type::BOOLEAN && !config.find("debug")->boolean);
+static_assert(config.find("proxy")->type == streamjson::JSONValue::Type::NULL_VALUE);
+static_assert(config.find("owners[1].name")->string() == "bo");
+static_assert(config.find("owners[0].age")->integer == 31);
+static_assert(config.find("owners[2]") == nullptr && config.find("missing") == nullptr && config.find("port.x") == nullptr);
+static_assert(config.find("empty")->raw == "{}");
+static_assert(config.find("escaped")->string() == R"(say \"hi\")");
+
+// Top-level arrays and scalars
+static_assert(streamjson::static_json<"[1, [2, 3], 4]">.find("[1][1]")->integer == 3);
+static_assert(streamjson::static_json<"[1, [2, 3], 4]">.find("[2]")->integer == 4);
+static_assert(streamjson::static_json<" true ">.root().boolean);
+
+// Numbers as the runtime JSONValue/strtod: correctly rounded, integers out of the int64_t range are floating
+static_assert(streamjson::static_json<"1e23">.root().floating == 1e23);
+static_assert(streamjson::static_json<"1.7976931348623157e308">.root().floating == 1.7976931348623157e308);
+static_assert(streamjson::static_json<"2.2250738585072014e-308">.root().floating == 2.2250738585072014e-308);
+static_assert(streamjson::static_json<"4.9e-324">.root().floating == 4.9e-324);
+static_assert(streamjson::static_json<"0.30000000000000004">.root().floating == 0.30000000000000004);
+static_assert(streamjson::static_json<"-9223372036854775808">.root().integer == std::numeric_limits<int64_t>::min());
+static_assert(streamjson::static_json<"9223372036854775808">.root().type == streamjson::JSONValue::Type::FLOATING);
+static_assert(streamjson::static_json<"9223372036854775808">.root().floating == 9223372036854775808.0);
+static_assert(streamjson::static_json<"-123456789012345678901">.root().floating == -123456789012345678901.0);
+
+// An exponent needs digits
+template<streamjson::detail::StaticString json>
+constexpr bool is_static_json = requires { typename std::integral_constant<size_t, streamjson::detail::StaticJSONParser(json.view(), nullptr).parse()>; };
+
+static_assert(is_static_json<"[1e5, 2E+3, 3.5e-1]">);
+static_assert(!is_static_json<"1e">);
+static_assert(!is_static_json<"[2.5E+]">);
+
+int main(int argc, char* argv[] )
+{
+    // Siblings are skipped through end
+    const auto & owners = *config.find("owners");
+    size_t index = &owners - config.nodes.data();
+
+    for (size_t owner = index + 1; owner < owners.end; owner = config.nodes[owner].end)
+    {
+        std::cout << config.nodes[owner].raw << std::endl;
+    }
+
+    return config.nodes.size() == 16 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace std::string_literals;
+
+// Documents recorded into tapes, written back from the tape and queried by path
+std::string write(const streamjson::Tape & tape, size_t index)
+{
+    switch (tape.kind(index))
+    {
+        case streamjson::StaticNode::Kind::VALUE:
+            return std::string(tape.raw(index));
+        default:
+        {
+            bool is_object = tape.kind(index) == streamjson::StaticNode::Kind::OBJECT;
+            std::string text = is_object ? "{" : "[";
+            for (size_t child = index + 1; child < tape.end(index); child = tape.end(child))
+            {
+                text += (child == index + 1) ? "" : ",";
+                if (is_object)
+                {
+                    text += "\"" + std::string(tape.key(child)) + "\":";
+                }
+                text += write(tape, child);
+            }
+            return text + (is_object ? "}" : "]");
+        }
+    }
+}
+
+int main(int argc, char* argv[] )
+{
+    std::string input = R"({"name": "gateway", "port": 8080, "ratio": 0.25,
+        "owners": [{"name": "ana", "tags": ["a", "b"]}, {"name": "b\"ob", "tags": []}],
+        "empty": {}, "flag": true, "none": null}
+        [1, [2, [3]], 4] [42])";
+
+    std::vector<std::string> expected = {
+        R"({"name":"gateway","port":8080,"ratio":0.25,"owners":[{"name":"ana","tags":["a","b"]},{"name":"b\"ob","tags":[]}],"empty":{},"flag":true,"none":null})",
+        R"([1,[2,[3]],4])",
+        R"([42])"
+    };
+
+    int result = 0;
+
+    for (size_t chunk_size : {1, 3, 7, 64, 4096})
+    {
+        std::vector<std::string> written;
+        size_t owners = 0;
+        int64_t port = 0;
+        std::string second_owner;
+
+        streamjson::TapeBuilder builder([&](const streamjson::Tape & tape)
+        {
+            written.push_back(write(tape, 0));
+
+            if (written.size() == 1)
+            {
+                size_t index = tape.find("owners");
+                for (size_t child = index + 1; child < tape.end(index); child = tape.end(child))
+                {
+                    owners += tape.find("tags", child) != std::string_view::npos;
+                }
+
+                port = tape.value(tape.find("port")).integer;
+                second_owner = tape.value(tape.find("owners[1].name")).string;
+
+                if (tape.find("owners[2]") != std::string_view::npos || tape.find("missing") != std::string_view::npos ||
+                    tape.find("port.x") != std::string_view::npos || tape.value(tape.find("flag")).boolean != true ||
+                    tape.value(tape.find("ratio")).floating != 0.25)
+                {
+                    std::cout << "Wrong lookup" << std::endl;
+                    result = 1;
+                }
+            }
+            else if (written.size() == 2 && tape.value(tape.find("[1][1][0]")).integer != 3)
+            {
+                std::cout << "Wrong nested lookup" << std::endl;
+                result = 1;
+            }
+        });
+
+        streamjson::AutofeedStreamJson<64> parser(builder);
+        feed_chunks(parser, input, chunk_size);
+        parser.feed(" ", 1);
+
+        if (parser.failed() || written != expected || owners != 2 || port != 8080 || second_owner != "b\\\"ob")
+        {
+            std::cout << "Chunk size " << chunk_size << " failed:" << std::endl;
+            for (const std::string & text : written)
+            {
+                std::cout << "  " << text << std::endl;
+            }
+            result = 1;
+        }
+
+        if (builder.tape().size() != 2 || builder.tape().value(1).integer != 42)
+        {
+            std::cout << "Wrong last tape" << std::endl;
+            result = 1;
+        }
+    }
+
+    // Typed values of a binary decoder are stored as JSON text
+    std::string msgpack = "\x83\xa1" "a" "\x01\xa1" "b" "\x92\xcb\x3f\xd0\x00\x00\x00\x00\x00\x00\xc3\xa1" "c" "\xa2" "hi"s;
+    streamjson::TapeBuilder builder;
+    streamjson::MessagePackStreamJson decoder(builder);
+    decoder.feed(msgpack.data(), msgpack.size());
+
+    std::string text = write(builder.tape(), 0);
+    if (text != R"({"a":1,"b":[0.25,true],"c":"hi"})")
+    {
+        std::cout << "Wrong MessagePack tape: " << text << std::endl;
+        result = 1;
+    }
+
+    // Floating values stay floating: typed 1.0 and 1e20 are written with a fraction or an exponent
+    std::string floats = "\x92\xcb\x3f\xf0\x00\x00\x00\x00\x00\x00\xcb\x44\x15\xaf\x1d\x78\xb5\x8c\x40"s;
+    decoder.feed(floats.data(), floats.size());
+
+    const streamjson::Tape & tape = builder.tape();
+    text = write(tape, 0);
+    if (text != "[1.0,1e+20]" || tape.value(1).type != streamjson::JSONValue::Type::FLOATING || tape.value(1).floating != 1.0 ||
+        tape.value(2).type != streamjson::JSONValue::Type::FLOATING || tape.value(2).floating != 1e20)
+    {
+        std::cout << "Wrong typed floating values: " << text << std::endl;
+        result = 1;
+    }
+
+    // Exponents and integers out of range read back as floating
+    streamjson::TapeBuilder numbers;
+    streamjson::AutofeedStreamJson<64> number_parser(numbers);
+    std::string number_input = "[1e3, 2.5E-1, -1, 12345678901234567890] ";
+    number_parser.feed(number_input.data(), number_input.size());
+
+    const streamjson::Tape & number_tape = numbers.tape();
+    if (numbers.failed() || number_tape.size() != 5 || number_tape.value(1).type != streamjson::JSONValue::Type::FLOATING ||
+        number_tape.value(1).floating != 1000.0 || number_tape.value(2).floating != 0.25 ||
+        number_tape.value(3).type != streamjson::JSONValue::Type::INTEGER || number_tape.value(3).integer != -1 ||
+        number_tape.value(4).type != streamjson::JSONValue::Type::FLOATING || number_tape.value(4).floating != 12345678901234567890.0)
+    {
+        std::cout << "Wrong numbers: " << write(number_tape, 0) << std::endl;
+        result = 1;
+    }
+
+    std::cout << (result ? "FAILED" : "OK") << std::endl;
+    return result;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Exposes the tape being recorded, to check that it stays within the size cap
+struct CappedListener : public streamjson::SubtreeListener<"owners\\[[0-9]+\\]", 1024>
+{
+    using SubtreeListener::SubtreeListener;
+
+    size_t recorded_size() const
+    {
+        const streamjson::Tape & tape = builder_.tape();
+        return tape.arena.size() + tape.size() * sizeof(streamjson::TapeNode);
+    }
+};
+
+// Owners older than 26, with the age before or after the name, and subtrees over the size cap
+int main(int argc, char* argv[] )
+{
+    std::string large(600, 'x');
+
+    std::string input = R"({"owners": [
+        {"name": "John", "age": 30, "cars": [{"name": "Ford"}, {"name": "BMW"}]},
+        {"age": 25, "name": "Jane"},
+        {"age": 27, "pets": {"owners": [{"name": "nested"}]}, "name": "Ana"},
+        {"name": "Big", "age": 40, "notes": [")" + large + R"(", ")" + large + R"("]},
+        {"name": "Bob"}
+    ], "other": {"name": "Eve", "age": 50}}
+    {"owners": [{"name": "Zoe", "age": 99}]})";
+
+    std::string expected = "owners[0]:John:2 owners[2]:Ana:0 owners[0]:Zoe:0 ";
+
+    int result = 0;
+
+    for (size_t chunk_size : {1, 5, 64, 4096})
+    {
+        std::string found;
+        size_t matches = 0;
+
+        streamjson::SubtreeListener<"owners\\[[0-9]+\\]", 1024> owners([&](const std::string_view & path, const streamjson::Tape & tape, const std::vector<size_t> & indexes)
+        {
+            matches++;
+
+            size_t age = tape.find("age");
+            if (age != std::string_view::npos && tape.value(age).integer > 26)
+            {
+                size_t cars = tape.find("cars");
+                size_t count = 0;
+                for (size_t car = cars + 1; cars != std::string_view::npos && car < tape.end(cars); car = tape.end(car))
+                {
+                    count++;
+                }
+
+                found += std::string(path) + ":" + tape.value(tape.find("name")).string + ":" + std::to_string(count) + " ";
+            }
+
+            if (indexes.size() != 1)
+            {
+                std::cout << "Wrong indexes" << std::endl;
+                result = 1;
+            }
+        });
+
+        streamjson::AutofeedStreamJson<2048> parser(owners);
+        feed_chunks(parser, input, chunk_size);
+        parser.feed(" ", 1);
+
+        if (parser.failed() || found != expected || matches != 5 || owners.truncated() != 1)
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << found << " " << matches << " " << owners.truncated() << std::endl;
+            result = 1;
+        }
+    }
+
+    // A single string over the cap is not appended to the tape
+    size_t recorded = 0;
+    CappedListener capped([&](const std::string_view & path, const streamjson::Tape & tape, const std::vector<size_t> & indexes)
+    {
+        recorded++;
+    });
+
+    std::string huge = R"({"owners": [{"name": ")" + std::string(5000, 'x') + R"("}, {"name": "Small"}]} )";
+    streamjson::AutofeedStreamJson<8192> capped_parser(capped);
+    size_t split = huge.find("}, {") + 1;
+    capped_parser.feed(huge.data(), split);
+    size_t peak = capped.recorded_size();
+    capped_parser.feed(huge.data() + split, huge.size() - split);
+
+    if (capped_parser.failed() || peak > 1024 || capped.truncated() != 1 || recorded != 1)
+    {
+        std::cout << "Large string: " << peak << " bytes recorded, " << capped.truncated() << " truncated, " << recorded << " recorded" << std::endl;
+        result = 1;
+    }
+
+    std::cout << (result ? "FAILED" : "OK") << std::endl;
+    return result;
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// JSONPath-like filters with the predicate fields before and after the selected value
+std::string run(const std::string & expression, const std::string & input, size_t chunk_size)
+{
+    std::string found;
+
+    streamjson::PredicateListener jobs(expression, [&](const std::string_view & path, const streamjson::JSONValue & value, const std::vector<size_t> & indexes)
+    {
+        found += std::string(path) + "=" + value.to_string() + " ";
+    });
+
+    if (!jobs.valid())
+    {
+        return "INVALID";
+    }
+
+    streamjson::AutofeedStreamJson<64> parser(jobs);
+    feed_chunks(parser, input, chunk_size);
+    parser.feed(" ", 1);
+
+    return parser.failed() ? "FAILED" : found;
+}
+
+int main(int argc, char* argv[] )
+{
+    std::string input = R"({"run": 7, "jobs": [
+        {"status": "completed", "conclusion": "success", "attempt": 1},
+        {"conclusion": "failure", "attempt": 2, "status": "completed"},
+        {"status": "in_progress", "conclusion": null, "attempt": 3},
+        {"conclusion": "skipped", "attempt": 4},
+        {"status": "completed", "steps": [{"status": "queued"}], "meta": {"runner": "linux"}, "conclusion": "cancelled", "attempt": 5.5},
+        {"status": "a && \"b\" && c", "conclusion": "quoted", "attempt": 6}
+    ], "other": [{"status": "completed", "conclusion": "ignored"}]}
+    [{"status": "completed", "conclusion": "root"}])";
+
+    struct Case
+    {
+        std::string expression;
+        std::string expected;
+    };
+
+    std::vector<Case> cases = {
+        {R"(jobs[?(@.status=="completed")].conclusion)", R"(jobs[0].conclusion=success jobs[1].conclusion=failure jobs[4].conclusion=cancelled )"},
+        {R"($.jobs[?(@.status == "completed" && @.attempt > 1)].conclusion)", R"(jobs[1].conclusion=failure jobs[4].conclusion=cancelled )"},
+        {R"(jobs[?(@.status != "completed")].attempt)", R"(jobs[2].attempt=3 jobs[5].attempt=6 )"},
+        {R"(jobs[?(@.attempt <= 2)].status)", R"(jobs[0].status=completed jobs[1].status=completed )"},
+        {R"(jobs[?(@.conclusion == null)].attempt)", R"(jobs[2].attempt=3 )"},
+        {R"(jobs[?(@.meta.runner=="linux")].steps[0].status)", R"(jobs[4].steps[0].status=queued )"},
+        {R"($[?(@.status=="completed")].conclusion)", R"(_[0].conclusion=root )"},
+        {R"(jobs[?(@.status=="a && \"b\" && c" && @.attempt == 6)].conclusion)", R"(jobs[5].conclusion=quoted )"},
+        {R"(jobs[?(@.status=="a && \"b\"")].conclusion)", ""},
+        {R"(jobs[?(@.status=="completed")].steps)", ""},
+        {R"(jobs[?(@.status)].conclusion)", "INVALID"},
+        {R"(jobs.conclusion)", "INVALID"}
+    };
+
+    int result = 0;
+
+    for (const Case & test : cases)
+    {
+        for (size_t chunk_size : {1, 7, 4096})
+        {
+            std::string found = run(test.expression, input, chunk_size);
+            if (found != test.expected)
+            {
+                std::cout << test.expression << " (" << chunk_size << "): " << found << std::endl;
+                result = 1;
+            }
+        }
+    }
+
+    std::cout << (result ? "FAILED" : "OK") << std::endl;
+    return result;
+}
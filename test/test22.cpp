@@ -0,0 +1,71 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Server-Sent Events framing: line ends split across chunks, multi-line data, comments, other fields and the end sentinel
+int main(int argc, char* argv[] )
+{
+    std::string input =
+        ": keep-alive comment\r\n"
+        "event: delta\r\n"
+        "id: 1\r\n"
+        "data: {\"text\": \"hel\"}\r\n"
+        "\r\n"
+        "data:{\"text\":\r"
+        "data: \"lo\",\n"
+        "data:  \"n\": [1,\r\n"
+        "data: 2]}\n"
+        "\n"
+        "retry: 1000\n"
+        "\n"
+        ": comments alone dispatch nothing\n"
+        "\n"
+        "data: [\"[DON\", \"E]\"]\n"
+        "\n"
+        "data: [\n"
+        "data: \"DONE]\"]\n"
+        "\n"
+        "data: [DONE]\r\n"
+        "\r\n";
+
+    std::string expected = "{K(text)V(hel)}|{K(text)V(lo)K(n)[V(1),V(2)]}|[V([DON),V(E])]|[V(DONE])]|";
+
+    bool ok = true;
+
+    for (size_t chunk_size : {1, 2, 3, 5, 1000})
+    {
+        TraceListener listener;
+        streamjson::AutofeedStreamJson<64> parser(listener);
+
+        size_t dispatched = 0;
+        streamjson::SSEDecoder<streamjson::AutofeedStreamJson<64>> sse(parser, [&]()
+        {
+            dispatched++;
+        });
+        sse.set_sentinel("[DONE]");
+
+        feed_chunks(sse, input, chunk_size);
+
+        if (parser.failed() || listener.trace != expected || sse.events() != 4 || dispatched != 4 || !sse.done())
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << listener.trace << " events: " << sse.events() << " done: " << sse.done() << std::endl;
+            ok = false;
+        }
+    }
+
+    // Without a sentinel every payload reaches the parser
+    TraceListener listener;
+    streamjson::AutofeedStreamJson<64> parser(listener);
+    streamjson::SSEDecoder<streamjson::AutofeedStreamJson<64>> sse(parser);
+    feed_chunks(sse, std::string("data: {\"a\": 1}\n\ndata: {\"b\": 2}\n\n"), 4);
+
+    std::cout << listener.trace << std::endl;
+
+    ok = ok && listener.trace == "{K(a)V(1)}|{K(b)V(2)}|" && sse.events() == 2 && !sse.done();
+
+    return ok ? 0 : 1;
+}
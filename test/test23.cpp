@@ -0,0 +1,74 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Deltas of string values received across chunks, strings inside arrays and open paths in nested arrays
+struct PartialListener : public streamjson::JSONListener
+{
+    void on_partial_value(const std::string_view & delta) override
+    {
+        partial += delta;
+        deltas++;
+    }
+
+    void on_value(const streamjson::JSONValue & value) override
+    {
+        // Deltas, when reported, add up to the complete value
+        if (deltas > 0 && partial != value.string)
+        {
+            mismatches++;
+        }
+        reported += deltas > 0;
+        trace += path() + "=" + value.to_string() + " ";
+        partial.clear();
+        deltas = 0;
+
+        JSONListener::on_value(value);
+    }
+
+    std::string trace;
+    std::string partial;
+    size_t deltas = 0;
+    size_t mismatches = 0;
+    size_t reported = 0;
+};
+
+int main(int argc, char* argv[] )
+{
+    std::string input = R"({"answer": "Hello \"quoted\" world \\ end", "list": ["alpha" , "be\"ta" ], "spaced": [ "a" , "b" ],
+        "nested": [[{"deep": "x\\"}, "y"], ["z", 1]], "last": "done"})";
+
+    std::string expected = R"(answer=Hello \"quoted\" world \\ end list[0]=alpha list[1]=be\"ta spaced[0]=a spaced[1]=b )"
+        R"(nested[0][0].deep=x\\ nested[0][1]=y nested[1][0]=z nested[1][1]=1 last=done )";
+
+    bool ok = true;
+
+    for (size_t chunk_size : {1, 2, 3, 1000})
+    {
+        PartialListener listener;
+        streamjson::AutofeedStreamJson<64> parser(listener);
+        feed_chunks(parser, input, chunk_size);
+
+        if (parser.failed() || listener.trace != expected || listener.mismatches != 0 ||
+            (chunk_size < 1000 && listener.reported == 0))
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << listener.trace << " mismatches: " << listener.mismatches << std::endl;
+            ok = false;
+        }
+    }
+
+    // Strings in arrays are values, with next element events
+    TraceListener trace;
+    streamjson::AutofeedStreamJson<64> parser(trace);
+    feed_chunks(parser, std::string(R"(["a" , "b" , "c\"" ])"), 1);
+
+    std::cout << trace.trace << std::endl;
+
+    ok = ok && trace.trace == R"([V(a),V(b),V(c\")]|)";
+
+    return ok ? 0 : 1;
+}
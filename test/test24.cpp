@@ -0,0 +1,152 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Minification compared with a byte by byte reference across chunk splits, and its throughput
+std::string naive_minify(const std::string & input)
+{
+    std::string output;
+    size_t depth = 0;
+    bool in_string = false;
+    bool escaped = false;
+    bool scalar = false;
+    bool separate = false;
+
+    for (const char c : input)
+    {
+        if (in_string)
+        {
+            output += c;
+            if (escaped)
+            {
+                escaped = false;
+            }
+            else if (c == '\\')
+            {
+                escaped = true;
+            }
+            else if (c == '"')
+            {
+                in_string = false;
+                scalar = depth == 0;
+            }
+            continue;
+        }
+
+        bool space = c == ' ' || c == '\n' || c == '\r' || c == '\t';
+        if (depth == 0)
+        {
+            if (space)
+            {
+                separate = separate || scalar;
+                scalar = false;
+            }
+            else
+            {
+                if (separate)
+                {
+                    output += '\n';
+                    separate = false;
+                }
+                scalar = c != '"' && c != '{' && c != '[' && c != '}' && c != ']';
+            }
+        }
+
+        if (space)
+        {
+            continue;
+        }
+
+        output += c;
+        if (c == '"')
+        {
+            in_string = true;
+        }
+        else if (c == '{' || c == '[')
+        {
+            depth++;
+        }
+        else if ((c == '}' || c == ']') && depth > 0 && --depth == 0)
+        {
+            output += '\n';
+        }
+    }
+
+    return output;
+}
+
+std::string minify(const std::string & input, size_t chunk_size)
+{
+    std::string output;
+    streamjson::MinifyStreamJson<64> minifier([&](const char * data, size_t size)
+    {
+        output.append(data, size);
+    });
+
+    feed_chunks(minifier, input, chunk_size);
+    minifier.flush();
+
+    return output;
+}
+
+int main(int argc, char* argv[] )
+{
+    std::string input = R"(1
+2
+true false {"a" : [1, 2]}  "top"  "level"
+{ "text" : "ab\"cdef \\", "b\\\\\\\"x" : "1234567\\",
+  "long" : "abcdefgh\"ijklmno\\pqrstuv\\\\wxyz\"\"  ", "n" : [ 1.5e3 , -0 , null ] }
+[ [ ] , { } ]  12345678901234567890   -1.0
+)";
+
+    // Move the escapes across every position of an eight byte word
+    for (size_t shift = 0; shift < 8; shift++)
+    {
+        input += "{\"" + std::string(shift, 'k') + "\" : \"" + std::string(shift, 'v') + "\\\"\\\\\\\"\\\\\" , \"x\" :  " + std::to_string(shift) + " }\n";
+    }
+
+    std::string expected = naive_minify(input);
+
+    std::string prefix = "1\n2\ntrue\nfalse\n{\"a\":[1,2]}\n\"top\"\n\"level\"\n";
+    bool ok = expected.compare(0, prefix.size(), prefix) == 0;
+
+    for (size_t chunk_size = 1; chunk_size <= 17; chunk_size++)
+    {
+        std::string actual = minify(input, chunk_size);
+        if (actual != expected)
+        {
+            std::cout << "Chunk size " << chunk_size << ":" << std::endl << actual;
+            ok = false;
+        }
+    }
+
+    std::cout << minify(input, 1000);
+
+    // Throughput on pretty printed records
+    std::string records;
+    for (int i = 0; i < 100000; i++)
+    {
+        records += "{\n    \"id\": " + std::to_string(i) + ",\n    \"name\": \"record number " + std::to_string(i) +
+            "\",\n    \"tags\": [ \"alpha\", \"beta\" ],\n    \"nested\": { \"value\": 12.5, \"flag\": true }\n}\n";
+    }
+
+    size_t minified = 0;
+    streamjson::MinifyStreamJson<65536> minifier([&](const char * data, size_t size)
+    {
+        minified += size;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    feed_chunks(minifier, records, 65536);
+    minifier.flush();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << records.size() << " -> " << minified << " bytes, "
+        << records.size() / std::chrono::duration<double, std::nano>(end - start).count() << " GB/s" << std::endl;
+
+    return ok ? 0 : 1;
+}
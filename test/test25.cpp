@@ -0,0 +1,71 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Canonical digests of documents that are equal or different as JSON values
+uint64_t digest(const std::string & input, size_t chunk_size)
+{
+    streamjson::CanonicalHashListener hash;
+    streamjson::AutofeedStreamJson<64> parser(hash);
+    feed_chunks(parser, input, chunk_size);
+
+    return parser.failed() || parser.documents() != 1 ? 0 : hash.digest();
+}
+
+int main(int argc, char* argv[] )
+{
+    struct Case
+    {
+        std::string left;
+        std::string right;
+        bool equal;
+    };
+
+    std::vector<Case> cases = {
+        {R"({"a": 1, "b": {"x": [1, 2], "y": "z"}})", R"({"b": {"y": "z", "x": [1, 2]}, "a": 1})", true},
+        {R"({"a": "café \"q\" \/"})", R"({"a": "café \"q\" /"})", true},
+        {R"({"a": 1})", R"({"a": 1})", true},
+        {R"({"a": 1})", R"({"a": 1.0})", true},
+        {R"({"a": 1})", R"({"a": 1e0})", true},
+        {R"({"a": 1000})", R"({"a": 1e3})", true},
+        {R"({"a": -0.5E-3})", R"({"a": -0.0005})", true},
+        {R"({"a": 1})", R"({"a": 1e3})", false},
+        {R"({"a": 1})", R"({"a": "1"})", false},
+        {R"({"a": 1.5})", R"({"a": 1.25})", false},
+        {R"([[1, 2], [3]])", R"([1, 2, 3])", false},
+        {R"([[1, 2], [3]])", R"([[1], [2, 3]])", false},
+        {R"([1, 2])", R"([2, 1])", false},
+        {R"({"a": {"b": 1}})", R"({"a": [1]})", false},
+        {R"({"a": 1, "b": 2})", R"({"a": 2, "b": 1})", false},
+        {R"({"a": null})", R"({"a": false})", false},
+        {R"([99999999999999999999])", R"([18446744073709551616])", false},
+        {R"([100000000000000000000])", R"([1e20])", true},
+        {R"([-9223372036854775809])", R"([-9.223372036854775809e18])", true},
+        {R"([9223372036854775807])", R"([9223372036854775806])", false}
+    };
+
+    bool ok = true;
+
+    for (const Case & test : cases)
+    {
+        for (size_t chunk_size : {1, 3, 1000})
+        {
+            uint64_t left = digest(test.left, chunk_size);
+            uint64_t right = digest(test.right, chunk_size);
+
+            if (left == 0 || right == 0 || (left == right) != test.equal)
+            {
+                std::cout << test.left << (test.equal ? " != " : " == ") << test.right << " (" << chunk_size << ")" << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    std::cout << std::hex << digest(cases[0].left, 1000) << std::endl;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+using namespace std::string_literals;
+
+// Numbers at matching paths folded into an Aggregate, from JSON text and from typed MessagePack values
+int main(int argc, char* argv[] )
+{
+    // More values than a batch, other paths and non numbers at the matching path are ignored
+    std::string input;
+    double sum = 0.0;
+    for (int i = 0; i < 1000; i++)
+    {
+        std::string value = (i % 3 == 0) ? std::to_string(i) + "e-1" : std::to_string(i);
+        sum += (i % 3 == 0) ? i / 10.0 : i;
+        input += R"({"req": {"latency": )" + value + R"(, "size": 7}, "latency": 1000000, "tags": ["x"]})" "\n";
+    }
+    input += R"({"req": {"latency": "slow"}} {"req": {"latency": null}} {"req": {"latency": [5]}})";
+
+    bool ok = true;
+
+    for (size_t chunk_size : {1, 7, 4096})
+    {
+        streamjson::AggregateListener<"req\\.latency"> latency;
+        streamjson::AutofeedStreamJson<128> parser(latency);
+        feed_chunks(parser, input, chunk_size);
+
+        streamjson::Aggregate aggregate = latency.aggregate();
+        if (parser.failed() || aggregate.count != 1000 || std::abs(aggregate.sum - sum) > 1e-6 ||
+            aggregate.min != 0.0 || aggregate.max != 998.0)
+        {
+            std::cout << "Chunk size " << chunk_size << ": count " << aggregate.count << " sum " << aggregate.sum
+                << " min " << aggregate.min << " max " << aggregate.max << std::endl;
+            ok = false;
+        }
+
+        latency.reset();
+        ok = ok && latency.aggregate().count == 0;
+    }
+
+    // Typed values: {"latency": 2.5} {"latency": -4} {"latency": "x"}
+    std::string msgpack = "\x81\xa7latency\xcb\x40\x04\x00\x00\x00\x00\x00\x00"
+        "\x81\xa7latency\xfc"
+        "\x81\xa7latency\xa1x"s;
+
+    streamjson::AggregateListener<"latency"> typed;
+    streamjson::MessagePackStreamJson decoder(typed);
+    decoder.feed(msgpack.data(), msgpack.size());
+
+    streamjson::Aggregate aggregate = typed.aggregate();
+    std::cout << "count " << aggregate.count << " sum " << aggregate.sum << " mean " << aggregate.mean() << std::endl;
+
+    ok = ok && !decoder.failed() && aggregate.count == 2 && aggregate.sum == -1.5 && aggregate.min == -4.0 && aggregate.max == 2.5;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Back-to-back documents without delimiters, as sent over a persistent connection
+const std::string json = "{\"id\": 1, \"status\": \"ok\"}{\"id\": 2, \"status\": \"error\"}\n[{\"id\": 3}] {\"id\": 4}";
+
+struct DocumentCounter : public streamjson::IJSONListener
+{
+    void on_document_end() override
+    {
+        count++;
+    }
+
+    size_t count = 0;
+};
+
+int main(int argc, char* argv[] )
+{
+    std::vector<int64_t> ids;
+
+    streamjson::FilterListener<"(_\\[[0-9]+\\]\\.)?id"> id_filter([&](const std::string_view & key, const streamjson::JSONValue & value, const std::vector<size_t> & indexes)
+    {
+        std::cout << key << " : " << value.to_string() << std::endl;
+        ids.push_back(value.integer);
+    });
+
+    DocumentCounter counter;
+    streamjson::MultiListener multi_filter({&id_filter, &counter});
+
+    constexpr size_t BUFFER_SIZE = 64;
+    streamjson::AutofeedStreamJson<BUFFER_SIZE> chunk_parser(multi_filter);
+
+    constexpr size_t CHUNK_SIZE = 7;
+    feed_chunks(chunk_parser, json, CHUNK_SIZE);
+
+    std::cout << "Documents: " << counter.count << std::endl;
+
+    bool ok = counter.count == 4 && chunk_parser.documents() == 4 && ids == std::vector<int64_t>{1, 2, 3, 4};
+
+    return ok ? 0 : 1;
+}
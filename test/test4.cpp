@@ -0,0 +1,89 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <streamjson.hpp>
+
+// HTTP response with a chunked body, chunk headers are split across writes below
+const std::vector<std::string> response = {
+    "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n",
+    "1",
+    "8\r\n{\"jobs\": [{\"status\": \"co\r\n",
+    "1b;name=value\r",
+    "\nmpleted\", \"conclusion\": \"su\r\n",
+    "16\r\nccess\"}, {\"status\": \"q\r\n",
+    "B\r\nueued\"}]}  \r\n",
+    "0\r\nX-Checksum: 1234\r\n\r\n",
+};
+
+int main(int argc, char* argv[] )
+{
+    // Loopback stand-in for an HTTP server
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+    {
+        return 1;
+    }
+
+    for (const auto & piece : response)
+    {
+        if (write(sockets[0], piece.data(), piece.size()) != static_cast<ssize_t>(piece.size()))
+        {
+            return 1;
+        }
+    }
+    close(sockets[0]);
+
+    std::vector<std::string> values;
+
+    streamjson::FilterListener<"jobs\\[[0-9]+\\]\\.(status|conclusion)"> jobs_filter([&](const std::string_view & key, const streamjson::JSONValue & value, const std::vector<size_t> & indexes)
+    {
+        std::cout << key << " : " << value.to_string() << std::endl;
+        values.push_back(value.to_string());
+    });
+
+    constexpr size_t BUFFER_SIZE = 64;
+    using ParserType = streamjson::AutofeedStreamJson<BUFFER_SIZE>;
+    ParserType chunk_parser(jobs_filter);
+    streamjson::ChunkedDecoder<ParserType> decoder(chunk_parser);
+
+    // Read the response with small reads, skipping the headers
+    constexpr size_t READ_SIZE = 5;
+    std::array<char, READ_SIZE> buffer;
+    std::string headers;
+    bool in_body = false;
+
+    ssize_t count;
+    while ((count = read(sockets[1], buffer.data(), buffer.size())) > 0)
+    {
+        size_t start = 0;
+
+        while (!in_body && start < static_cast<size_t>(count))
+        {
+            headers += buffer[start++];
+            in_body = headers.ends_with("\r\n\r\n");
+        }
+
+        decoder.feed(buffer.data() + start, count - start);
+    }
+    close(sockets[1]);
+
+    bool ok = decoder.done() && values == std::vector<std::string>{"completed", "success", "queued"};
+
+    // Leading zeros in chunk sizes are not significant digits, more than 15 significant digits are rejected
+    std::string padded = "0000000000000001b\r\n{\"jobs\": [{\"status\": \"x\"}]}\r\n00000000000000000\r\n\r\n";
+    ParserType padded_parser(jobs_filter);
+    streamjson::ChunkedDecoder<ParserType> padded_decoder(padded_parser);
+    padded_decoder.feed(padded.data(), padded.size());
+
+    ParserType oversized_parser(jobs_filter);
+    streamjson::ChunkedDecoder<ParserType> oversized_decoder(oversized_parser);
+    oversized_decoder.feed("1000000000000000\r\n", 18);
+
+    ok = ok && padded_decoder.done() && values.back() == "x" && oversized_decoder.failed();
+
+    return ok ? 0 : 1;
+}
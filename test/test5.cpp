@@ -0,0 +1,63 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+std::string compress(const std::string & input)
+{
+    z_stream stream = {};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+
+    std::string output(deflateBound(&stream, input.size()) + 32, '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+    stream.avail_in = input.size();
+    stream.next_out = reinterpret_cast<Bytef *>(output.data());
+    stream.avail_out = output.size();
+
+    deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return output;
+}
+
+int main(int argc, char* argv[] )
+{
+    // Highly compressible input, much larger than the parser buffer
+    constexpr size_t RECORDS = 10000;
+    std::string json;
+    for (size_t i = 0; i < RECORDS; i++)
+    {
+        json += "{\"id\": " + std::to_string(i) + ", \"status\": \"completed\", \"padding\": \"" + std::string(100, 'x') + "\"}\n";
+    }
+
+    std::string gzipped = compress(json);
+    std::cout << "Compressed " << json.size() << " bytes to " << gzipped.size() << " bytes" << std::endl;
+
+    int64_t sum = 0;
+    size_t count = 0;
+
+    streamjson::FilterListener<"id"> id_filter([&](const std::string_view & key, const streamjson::JSONValue & value, const std::vector<size_t> & indexes)
+    {
+        sum += value.integer;
+        count++;
+    });
+
+    constexpr size_t BUFFER_SIZE = 256;
+    using ParserType = streamjson::AutofeedStreamJson<BUFFER_SIZE>;
+    ParserType chunk_parser(id_filter);
+    streamjson::GzipDecoder<ParserType> decoder(chunk_parser);
+
+    constexpr size_t CHUNK_SIZE = 100;
+    feed_chunks(decoder, gzipped, CHUNK_SIZE);
+
+    std::cout << "Records: " << count << " documents: " << chunk_parser.documents() << std::endl;
+
+    bool ok = decoder.done() && !decoder.failed() && !chunk_parser.failed() &&
+        count == RECORDS && sum == static_cast<int64_t>(RECORDS * (RECORDS - 1) / 2);
+
+    return ok ? 0 : 1;
+}
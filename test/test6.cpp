@@ -0,0 +1,80 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+const std::string json = " \
+{ \"id\": 42, \
+  \"name\": \"say \\\"hi\\\"\", \
+  \"ratio\": 0.5, \
+  \"active\": true, \
+  \"parent\": null, \
+  \"tags\": [\"a\", \"b\"], \
+  \"matrix\": [[1, 2], [], [3]], \
+  \"items\": [{\"x\": 1}, {\"x\": 2}, 7], \
+  \"empty\": {} \
+}";
+
+const std::string expected = "{\"id\":42,\"name\":\"say \\\"hi\\\"\",\"ratio\":0.5,\"active\":true,\"parent\":null,"
+    "\"tags\":[\"a\",\"b\"],\"matrix\":[[1,2],[],[3]],\"items\":[{\"x\":1},{\"x\":2},7],\"empty\":{}}\n"
+    "{\"note\":\"line\\nbreak \\\"quoted\\\" \\u0001\",\"count\":-3}\n";
+
+int main(int argc, char* argv[] )
+{
+    std::string output;
+
+    constexpr size_t OUTPUT_BUFFER_SIZE = 16;
+    streamjson::JSONWriter<OUTPUT_BUFFER_SIZE> writer([&](const char * data, size_t size)
+    {
+        output.append(data, size);
+    });
+
+    // Parse and re-emit the document by chunks
+    constexpr size_t BUFFER_SIZE = 64;
+    streamjson::AutofeedStreamJson<BUFFER_SIZE> chunk_parser(writer);
+
+    constexpr size_t CHUNK_SIZE = 10;
+    feed_chunks(chunk_parser, json, CHUNK_SIZE);
+
+    // Build a document from application values
+    writer.on_object_start();
+    writer.write_key("note");
+    writer.write_string("line\nbreak \"quoted\" \x01");
+    writer.write_key("count");
+    writer.write_integer(-3);
+    writer.on_object_end();
+    writer.on_document_end();
+
+    writer.flush();
+
+    std::cout << output;
+
+    bool ok = output == expected;
+
+    // Numbers are written as found in the input
+    const std::string numbers = "{\"a\":1e5,\"b\":-0.5E-3,\"c\":[1.0,0.25e+2,-0],\"d\":1.0,\"e\":12345678901234567890,\"f\":-99999999999999999999.5}\n";
+
+    for (size_t chunk_size : {1, 3, 1000})
+    {
+        std::string round_trip;
+        streamjson::JSONWriter<OUTPUT_BUFFER_SIZE> number_writer([&](const char * data, size_t size)
+        {
+            round_trip.append(data, size);
+        });
+
+        streamjson::AutofeedStreamJson<BUFFER_SIZE> number_parser(number_writer);
+        feed_chunks(number_parser, numbers, chunk_size);
+        number_writer.flush();
+
+        if (round_trip != numbers)
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << round_trip;
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
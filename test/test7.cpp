@@ -0,0 +1,89 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+const std::string json = " \
+{ \"owners\": [ \
+        {   \
+            \"name\": \"John\", \
+            \"age\": 30, \
+            \"cars\":  [ { \"name\": \"Ford\", \"year\": 2010 }, { \"name\": \"BMW\", \"year\": 2015 } ] \
+        }, \
+        {   \
+            \"age\": 12 \
+        }, \
+        {   \
+            \"name\": \"Jane \\\"JJ\\\"\", \
+            \"age\": 25, \
+            \"cars\":  [ { \"name\": \"Audi\", \"extras\": { \"color\": \"red\", \"seats\": [1, 2] } } ] \
+        } \
+    ], \
+  \"total\": 3 \
+}";
+
+const std::string expected_projection =
+    "{\"owners\":[{\"name\":\"John\",\"cars\":[{\"name\":\"Ford\"},{\"name\":\"BMW\"}]},"
+    "{\"name\":\"Jane \\\"JJ\\\"\",\"cars\":[{\"name\":\"Audi\",\"extras\":{ \"color\": \"red\", \"seats\": [1, 2] }}]}],"
+    "\"total\":3}\n";
+
+std::string replace(std::string input, const std::string & from, const std::string & to)
+{
+    return input.replace(input.find(from), from.size(), to);
+}
+
+const std::string expected_redaction =
+    replace(replace(replace(json,
+        "\"John\"", "\"***\""),
+        "\"Jane \\\"JJ\\\"\"", "\"***\""),
+        "{ \"color\": \"red\", \"seats\": [1, 2] }", "{}");
+
+int main(int argc, char* argv[] )
+{
+    bool ok = true;
+
+    for (size_t chunk_size : {1, 10, 1000})
+    {
+        std::string output;
+
+        constexpr size_t OUTPUT_BUFFER_SIZE = 64;
+        streamjson::ProjectionStreamJson<OUTPUT_BUFFER_SIZE> projection({"owners[*].name", "owners[*].cars[*].name", "owners[2].cars[*].extras", "total"},
+            [&](const char * data, size_t size)
+            {
+                output.append(data, size);
+            });
+
+        feed_chunks(projection, json, chunk_size);
+        projection.flush();
+
+        if (output != expected_projection)
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << output;
+            ok = false;
+        }
+    }
+
+    for (size_t chunk_size : {1, 10, 1000})
+    {
+        std::string output;
+
+        streamjson::RedactionStreamJson redaction({{"owners[*].name", "\"***\""}, {"owners[*].cars[*].extras", "{}"}},
+            [&](const char * data, size_t size)
+            {
+                output.append(data, size);
+            });
+
+        feed_chunks(redaction, json, chunk_size);
+
+        if (output != expected_redaction)
+        {
+            std::cout << "Chunk size " << chunk_size << ": " << output << std::endl;
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
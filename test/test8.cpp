@@ -0,0 +1,106 @@
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// GROUP BY service, status COUNT(*), SUM(latency) over NDJSON logs
+struct Result
+{
+    size_t records = 0;
+    double sum = 0.0;
+
+    bool operator==(const Result & other) const = default;
+};
+
+using ResultMap = std::map<std::string, Result>;
+
+ResultMap collect(const streamjson::GroupByListener & group_by)
+{
+    ResultMap results;
+
+    group_by.for_each([&](const std::vector<std::string_view> & keys, size_t records, const streamjson::Aggregate & aggregate)
+    {
+        Result & result = results[std::string(keys[0]) + " " + std::string(keys[1])];
+        result.records += records;
+        result.sum += aggregate.sum;
+    });
+
+    return results;
+}
+
+void parse(streamjson::GroupByListener & group_by, const std::string & input)
+{
+    constexpr size_t BUFFER_SIZE = 128;
+    streamjson::AutofeedStreamJson<BUFFER_SIZE> chunk_parser(group_by);
+
+    constexpr size_t CHUNK_SIZE = 50;
+    feed_chunks(chunk_parser, input, CHUNK_SIZE);
+}
+
+int main(int argc, char* argv[] )
+{
+    const std::vector<std::string> services = {"api", "auth", "billing"};
+
+    ResultMap expected;
+    std::string logs;
+
+    for (size_t i = 0; i < 3000; i++)
+    {
+        const std::string & service = services[i % services.size()];
+        int status = (i % 7 == 0) ? 500 : 200;
+        int latency = static_cast<int>(i % 100);
+
+        logs += "{\"ts\": " + std::to_string(i) + ", \"service\": \"" + service + "\", \"http\": {\"status\": " + std::to_string(status) +
+            "}, \"latency\": " + std::to_string(latency) + "}\n";
+
+        Result & result = expected["\"" + service + "\" " + std::to_string(status)];
+        result.records++;
+        result.sum += latency;
+    }
+
+    // Single pass
+    streamjson::GroupByListener group_by({"service", "http.status"}, "latency");
+    parse(group_by, logs);
+
+    // Per thread partials over shards split at record boundaries, merged at the end
+    constexpr size_t THREADS = 4;
+    std::vector<std::string> shards(THREADS);
+    size_t start = 0;
+    for (size_t t = 0; t < THREADS; t++)
+    {
+        size_t end = (t == THREADS - 1) ? logs.size() : logs.find('\n', (logs.size() * (t + 1)) / THREADS) + 1;
+        shards[t] = logs.substr(start, end - start);
+        start = end;
+    }
+
+    std::vector<streamjson::GroupByListener> partials(THREADS, streamjson::GroupByListener({"service", "http.status"}, "latency"));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            parse(partials[t], shards[t]);
+        });
+    }
+
+    streamjson::GroupByListener merged({"service", "http.status"}, "latency");
+    for (size_t t = 0; t < THREADS; t++)
+    {
+        threads[t].join();
+        merged.merge(partials[t]);
+    }
+
+    for (const auto & [key, result] : collect(merged))
+    {
+        std::cout << key << " count: " << result.records << " sum: " << result.sum << std::endl;
+    }
+
+    bool ok = group_by.size() == 6 && collect(group_by) == expected && collect(merged) == expected;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <streamjson.hpp>
+
+#include "test_helpers.hpp"
+
+// Distinct users and most requested paths of an access log, parsed in two shards and merged
+using DistinctUsers = streamjson::DistinctCountListener<"user">;
+using TopPaths = streamjson::HeavyHittersListener<"request\\.path", 4>;
+
+void parse(streamjson::IJSONListener & listener, const std::string & input)
+{
+    constexpr size_t BUFFER_SIZE = 128;
+    streamjson::AutofeedStreamJson<BUFFER_SIZE> chunk_parser(listener);
+
+    constexpr size_t CHUNK_SIZE = 37;
+    feed_chunks(chunk_parser, input, CHUNK_SIZE);
+}
+
+int main(int argc, char* argv[] )
+{
+    constexpr size_t RECORDS = 20000;
+    constexpr size_t USERS = 5000;
+
+    std::string shards[2];
+
+    for (size_t i = 0; i < RECORDS; i++)
+    {
+        // "/" is requested 1/2 of the times, "/login" 1/4, "/cart" 1/8, then a long tail
+        size_t rank = std::countr_zero(i + 1);
+        std::string path = rank == 0 ? "/" : rank == 1 ? "/login" : rank == 2 ? "/cart" : "/item/" + std::to_string(i);
+
+        shards[i % 2] += "{\"user\": \"u" + std::to_string((i * 7919) % USERS) + "\", \"request\": {\"path\": \"" + path + "\"}}\n";
+    }
+
+    DistinctUsers users[2];
+    TopPaths paths[2];
+
+    for (size_t s = 0; s < 2; s++)
+    {
+        streamjson::MultiListener listener;
+        listener.add_listener(users[s]);
+        listener.add_listener(paths[s]);
+        parse(listener, shards[s]);
+    }
+
+    users[0].merge(users[1]);
+    paths[0].merge(paths[1]);
+
+    double users_estimate = users[0].estimate();
+    std::cout << "distinct users: " << users_estimate << std::endl;
+
+    auto top = paths[0].top();
+    for (const auto & entry : top)
+    {
+        std::cout << entry.value << " " << entry.count << " (error " << entry.error << ")" << std::endl;
+    }
+
+    bool ok = std::abs(users_estimate - USERS) < 0.05 * USERS;
+    ok = ok && top.size() == 4 && top[0].value == "\"/\"" && top[1].value == "\"/login\"" && top[2].value == "\"/cart\"";
+    ok = ok && paths[0].count("\"/\"") >= RECORDS / 2 && paths[0].count("\"/login\"") < RECORDS / 2;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+#include <streamjson.hpp>
+
+// Every event as text, to compare the events of different inputs, parsers or chunk sizes
+struct TraceListener : public streamjson::IJSONListener
+{
+    void on_object_start() override { trace += "{"; }
+    void on_object_end() override { trace += "}"; }
+    void on_array_start() override { trace += "["; }
+    void on_array_end() override { trace += "]"; }
+    void on_array_next_element() override { trace += ","; }
+    void on_key(const std::string_view & key) override { trace += "K(" + std::string(key) + ")"; }
+    void on_value(const streamjson::JSONValue & value) override { trace += "V(" + value.to_string() + ")"; }
+    void on_document_end() override { trace += "|"; }
+
+    std::string trace;
+};
+
+// Feeds the input to anything with feed(data, size) in chunks of chunk_size bytes
+template<typename ParserType>
+void feed_chunks(ParserType & parser, const std::string_view & input, size_t chunk_size)
+{
+    for (size_t offset = 0; offset < input.size(); offset += chunk_size)
+    {
+        parser.feed(input.data() + offset, std::min(chunk_size, input.size() - offset));
+    }
+}